@@ -0,0 +1,141 @@
+// access_log_bench.cpp
+//
+// Request-thread cost of access logging: the old inline
+// fprintf(stdout, "%s %s -> %d\n", ...) against AccessLog::record, with
+// several threads logging at once. Run once into a regular file and once
+// into a pipe whose reader drains only ~1 MiB/s, standing in for a slow log
+// shipper. Reports records per second across all threads, the slowest
+// single call, and how many AccessLog entries were dropped.
+//
+// Usage: bench_access_log [threads] [records_per_thread]
+
+#include "../include/AccessLog.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* kBenchLog = "bench_access_log.out";
+
+struct Result {
+    double records_per_second = 0;
+    double max_call_us = 0;
+};
+
+Result run(std::size_t threads, std::size_t records, const std::function<void(std::size_t)>& log) {
+    std::vector<std::thread> workers;
+    std::vector<double> max_call_us(threads, 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (std::size_t i = 0; i < records; ++i) {
+                const auto call = std::chrono::steady_clock::now();
+                log(i);
+                max_call_us[t] = std::max(max_call_us[t], std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - call).count());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    return Result{static_cast<double>(threads * records) / seconds,
+                  *std::max_element(max_call_us.begin(), max_call_us.end())};
+}
+
+// A pipe whose read end is drained at about 1 MiB/s until closed.
+struct SlowPipe {
+    std::FILE* out = nullptr;
+    int read_fd = -1;
+    std::thread reader;
+
+    SlowPipe() {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            std::perror("pipe");
+            std::exit(1);
+        }
+        read_fd = fds[0];
+        out = fdopen(fds[1], "w");
+        reader = std::thread([fd = read_fd] {
+            char buf[4096];
+            while (read(fd, buf, sizeof(buf)) > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(4));
+            }
+        });
+    }
+
+    ~SlowPipe() {
+        std::fclose(out);
+        reader.join();
+        close(read_fd);
+    }
+};
+
+void report(const char* destination, const char* logger, const Result& r, std::uint64_t dropped) {
+    std::printf("%-12s %-10s %14.0f %16.1f %12llu\n", destination, logger,
+                r.records_per_second, r.max_call_us, static_cast<unsigned long long>(dropped));
+}
+
+void compare(const char* destination, std::FILE* out, std::size_t threads, std::size_t records) {
+    const Result inline_result = run(threads, records, [out](std::size_t i) {
+        std::fprintf(out, "%s %s -> %d\n", "GET", "/api/ls", i % 100 == 0 ? 404 : 200);
+    });
+    std::fflush(out);
+    report(destination, "fprintf", inline_result, 0);
+
+    std::uint64_t dropped_before = 0;
+    std::uint64_t dropped_after = 0;
+    Result async_result;
+    {
+        AccessLog log(AccessLogConfig{out});
+        dropped_before = log.stats().dropped;
+        async_result = run(threads, records, [&log](std::size_t i) {
+            log.record("GET", "/api/ls", i % 100 == 0 ? 404 : 200,
+                       std::chrono::microseconds(120), 2048, "127.0.0.1");
+        });
+        dropped_after = log.stats().dropped;
+    }
+    report(destination, "AccessLog", async_result, dropped_after - dropped_before);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t threads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8;
+    const std::size_t records = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+
+    std::printf("%zu threads x %zu records\n\n", threads, records);
+    std::printf("%-12s %-10s %14s %16s %12s\n", "destination", "logger", "records/s", "max call us", "dropped");
+
+    {
+        std::FILE* file = std::fopen(kBenchLog, "w");
+        if (file == nullptr) {
+            std::perror(kBenchLog);
+            return 1;
+        }
+        compare("file", file, threads, records);
+        std::fclose(file);
+        std::remove(kBenchLog);
+    }
+
+    {
+        SlowPipe pipe;
+        compare("slow pipe", pipe.out, threads, records / 20);
+    }
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+// admission_bench.cpp
+//
+// Read latency under write bursts, with and without AdmissionController.
+// A fixed pool of worker threads (standing in for HttpServer's workers)
+// serves an open-loop request stream: a read (ls_by_parent_id of ROOT)
+// every millisecond, plus bursts of batch creates that hold the
+// TaskService write lock. Latency is measured from arrival to completion,
+// so time queued behind busy workers counts, as it does for clients.
+//
+// Usage: bench_admission [workers] [seconds] [burst_size] [tasks_per_batch]
+
+#include "../include/AdmissionController.hpp"
+#include "../include/Database.hpp"
+#include "../include/TaskService.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* kBenchDb = "bench_admission.db";
+
+void remove_db() {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::remove((std::string(kBenchDb) + suffix).c_str());
+    }
+}
+
+struct Request {
+    bool write;
+    Clock::time_point arrived;
+};
+
+struct Result {
+    std::vector<double> read_ms;
+    std::size_t reads_rejected = 0;
+    std::size_t writes_done = 0;
+    std::size_t writes_rejected = 0;
+};
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[static_cast<std::size_t>(p * static_cast<double>(values.size() - 1))];
+}
+
+Result run(bool admission, std::size_t workers, double seconds,
+           std::size_t burst_size, std::size_t tasks_per_batch) {
+    remove_db();
+    Database db(kBenchDb);
+    TaskService service(db);
+
+    std::vector<TaskDraft> batch(tasks_per_batch);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        batch[i].title = "imported " + std::to_string(i);
+    }
+    const std::string parent = service.create("/", "imports")->get_id();
+    for (int i = 0; i < 200; ++i) {
+        service.create("/", "listed " + std::to_string(i));
+    }
+
+    AdmissionController controller(AdmissionConfig{}, workers);
+    controller.add_route("GET /api/ls", AdmissionController::RouteClass::READ);
+    controller.add_route("POST /api/batch/create", AdmissionController::RouteClass::BULK);
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Request> queue;
+    bool done = false;
+    Result result;
+
+    std::vector<std::thread> pool;
+    for (std::size_t w = 0; w < workers; ++w) {
+        pool.emplace_back([&] {
+            while (true) {
+                Request request;
+                {
+                    std::unique_lock lock(mutex);
+                    ready.wait(lock, [&] { return done || !queue.empty(); });
+                    if (queue.empty()) {
+                        return;
+                    }
+                    request = queue.front();
+                    queue.pop_front();
+                }
+
+                AdmissionController::Ticket ticket;
+                if (admission) {
+                    const auto outcome = controller.admit(
+                        request.write ? "POST /api/batch/create" : "GET /api/ls",
+                        Clock::now() - request.arrived, ticket);
+                    if (outcome != AdmissionController::Outcome::ADMITTED) {
+                        std::lock_guard lock(mutex);
+                        ++(request.write ? result.writes_rejected : result.reads_rejected);
+                        continue;
+                    }
+                }
+
+                if (request.write) {
+                    service.create_batch(parent, batch);
+                } else {
+                    service.ls_by_parent_id("ROOT");
+                }
+                ticket.reset();
+
+                const double ms = std::chrono::duration<double, std::milli>(
+                    Clock::now() - request.arrived).count();
+                std::lock_guard lock(mutex);
+                if (request.write) {
+                    ++result.writes_done;
+                } else {
+                    result.read_ms.push_back(ms);
+                }
+            }
+        });
+    }
+
+    // Arrivals: a read every 1 ms, and a burst of writes every 250 ms.
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds));
+    auto next_burst = start;
+    for (auto now = start; now < end; now = Clock::now()) {
+        {
+            std::lock_guard lock(mutex);
+            if (now >= next_burst) {
+                for (std::size_t i = 0; i < burst_size; ++i) {
+                    queue.push_back({true, now});
+                }
+                next_burst += std::chrono::milliseconds(250);
+            }
+            queue.push_back({false, now});
+        }
+        ready.notify_all();
+        std::this_thread::sleep_until(now + std::chrono::milliseconds(1));
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        done = true;
+    }
+    ready.notify_all();
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    service.sync();
+    remove_db();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t workers = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8;
+    const double seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 3.0;
+    const std::size_t burst_size = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 8;
+    const std::size_t tasks_per_batch = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1000;
+
+    if (workers == 0) {
+        std::fprintf(stderr, "error: workers must be positive\n");
+        return 1;
+    }
+
+    std::printf("%zu workers, %.1f s, bursts of %zu batch creates x %zu tasks every 250 ms\n\n",
+                workers, seconds, burst_size, tasks_per_batch);
+    std::printf("%-10s %10s %10s %10s %14s %10s %14s\n", "admission", "read p50", "read p99",
+                "read max", "reads rejected", "writes", "writes rejected");
+
+    for (const bool admission : {false, true}) {
+        Result r = run(admission, workers, seconds, burst_size, tasks_per_batch);
+        const double p50 = percentile(r.read_ms, 0.50);
+        const double p99 = percentile(r.read_ms, 0.99);
+        const double max = r.read_ms.empty() ? 0 : r.read_ms.back();
+        std::printf("%-10s %8.1fms %8.1fms %8.1fms %14zu %10zu %14zu\n",
+                    admission ? "on" : "off", p50, p99, max,
+                    r.reads_rejected, r.writes_done, r.writes_rejected);
+    }
+
+    return 0;
+}
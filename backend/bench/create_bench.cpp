@@ -0,0 +1,76 @@
+// create_bench.cpp
+//
+// Creates per second through Database: the old create path (INSERT with
+// default status/priority, then an UPDATE to set them, two autocommits)
+// against create_task_under with the full field set (one INSERT).
+//
+// Usage: bench_create [creates]
+
+#include "../include/Database.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+namespace {
+
+const char* kBenchDb = "bench_create.db";
+
+void remove_db() {
+    std::remove(kBenchDb);
+    std::remove((std::string(kBenchDb) + "-wal").c_str());
+    std::remove((std::string(kBenchDb) + "-shm").c_str());
+}
+
+double creates_per_second(std::size_t creates,
+                          const std::function<void(Database&, std::size_t)>& create) {
+    remove_db();
+    Database db(kBenchDb);
+    db.ensure_root();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < creates; ++i) {
+        create(db, i);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return static_cast<double>(creates) /
+           std::chrono::duration<double>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t creates = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+
+    try {
+        const double before = creates_per_second(creates, [](Database& db, std::size_t i) {
+            TaskNode node = db.create_task_under("ROOT", "task " + std::to_string(i));
+            node.set_status(TaskStatus::IN_PROGRESS);
+            node.set_priority(TaskPriority::HIGH);
+            db.update_task_fields(node);
+        });
+
+        const double after = creates_per_second(creates, [](Database& db, std::size_t i) {
+            db.create_task_under(
+                "ROOT",
+                "task " + std::to_string(i),
+                "",
+                TaskStatus::IN_PROGRESS,
+                TaskPriority::HIGH
+            );
+        });
+
+        std::printf("creates=%zu\n", creates);
+        std::printf("insert + update: %10.0f creates/s\n", before);
+        std::printf("single insert:   %10.0f creates/s\n", after);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "bench failed: %s\n", e.what());
+        return 1;
+    }
+
+    remove_db();
+    return 0;
+}
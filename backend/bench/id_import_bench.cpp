@@ -0,0 +1,126 @@
+// id_import_bench.cpp
+//
+// Bulk-imports a synthetic workspace through Database::insert_task once
+// with random ids (TaskId::generate, what generate_id used to produce) and
+// once with time-ordered ids (TaskId::generate_ordered), each into a fresh
+// database file. Reports import throughput and the file size after a WAL
+// checkpoint, plus the sqlite_autoindex on tasks.id in pages.
+//
+// Usage: bench_id_import [task_count] [fanout] [batch]
+
+#include "../include/Database.hpp"
+#include "../include/TaskId.hpp"
+
+#include <sqlite3.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* kBenchDb = "bench_id_import.db";
+
+void remove_db() {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::remove((std::string(kBenchDb) + suffix).c_str());
+    }
+}
+
+struct Result {
+    double seconds = 0;
+    std::uintmax_t file_bytes = 0;
+    long long id_index_pages = 0;
+};
+
+// Returns -1 if `sql` cannot be prepared.
+long long query_int(sqlite3* db, const char* sql) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return -1;  // e.g. SQLite built without the dbstat table
+    }
+    const long long value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    return value;
+}
+
+// Seeds `count` tasks under ROOT as a tree where every node has `fanout`
+// children, committing every `batch` rows as an import would.
+Result import(std::size_t count, std::size_t fanout, std::size_t batch,
+              const std::function<TaskId()>& next_id) {
+    remove_db();
+    Result result;
+
+    {
+        Database db(kBenchDb);
+        db.ensure_root();
+
+        std::vector<std::string> ids{"ROOT"};
+        ids.reserve(count + 1);
+
+        const std::time_t now = std::time(nullptr);
+        const auto start = std::chrono::steady_clock::now();
+
+        db.begin();
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i > 0 && i % batch == 0) {
+                db.commit();
+                db.begin();
+            }
+
+            ids.push_back(next_id().to_hex());
+            const TaskNode node(ids.back(), "task " + std::to_string(i), "",
+                                TaskStatus::TODO, TaskPriority::MEDIUM, now, now);
+            db.insert_task(node, ids[i / fanout]);
+        }
+        db.commit();
+
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Closing the last connection checkpoints the WAL into the main file.
+    sqlite3* raw = nullptr;
+    if (sqlite3_open(kBenchDb, &raw) != SQLITE_OK) {
+        throw std::runtime_error("open failed");
+    }
+    result.id_index_pages = query_int(raw,
+        "SELECT count(*) FROM dbstat WHERE name = 'sqlite_autoindex_tasks_1';");
+    sqlite3_close(raw);
+
+    result.file_bytes = std::filesystem::file_size(kBenchDb);
+    remove_db();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::size_t fanout = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10;
+    const std::size_t batch = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10000;
+
+    if (fanout == 0 || batch == 0) {
+        std::fprintf(stderr, "error: fanout and batch must be positive\n");
+        return 1;
+    }
+
+    const Result random = import(count, fanout, batch, [] { return TaskId::generate(); });
+    const Result ordered = import(count, fanout, batch, [] { return TaskId::generate_ordered(); });
+
+    std::printf("%zu tasks, fanout %zu, %zu rows per transaction\n\n", count, fanout, batch);
+    std::printf("%-14s %14s %12s %16s\n", "ids", "tasks/s", "file MiB", "id index pages");
+    for (const auto& [name, r] : {std::pair{"random", random}, std::pair{"time-ordered", ordered}}) {
+        std::printf("%-14s %14.0f %12.1f %16lld\n", name,
+                    static_cast<double>(count) / r.seconds,
+                    static_cast<double>(r.file_bytes) / 1048576.0,
+                    r.id_index_pages);
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+// id_lookup_bench.cpp
+//
+// Microbenchmark for TaskService::find_by_id: compares the id index, shared
+// lock included, against the depth-first search it replaced, on in-memory
+// databases of 10k, 100k and 1M tasks.
+//
+// Usage: bench_id_lookup [lookups_per_size]
+
+#include "../include/Database.hpp"
+#include "../include/TaskService.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The lookup TaskService used before the index: a DFS over the whole tree.
+TaskNode::Ptr dfs_find(const TaskNode::Ptr& root, std::string_view id) {
+    if (root->get_id() == id) {
+        return root;
+    }
+
+    std::vector<TaskNode::Ptr> search_space{root};
+    while (!search_space.empty()) {
+        TaskNode::Ptr current = search_space.back();
+        search_space.pop_back();
+
+        for (const auto& child : current->get_children()) {
+            if (child->get_id() == id) {
+                return child;
+            }
+            search_space.push_back(child);
+        }
+    }
+    return nullptr;
+}
+
+// Seeds `count` tasks, each under a random earlier task, and returns ids.
+std::vector<std::string> seed(Database& db, std::size_t count) {
+    db.ensure_root();
+
+    std::mt19937 rng{42};
+    std::vector<std::string> ids{"ROOT"};
+    ids.reserve(count + 1);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uniform_int_distribution<std::size_t> pick(0, ids.size() - 1);
+        TaskNode node("task " + std::to_string(i));
+        db.insert_task(node, ids[pick(rng)]);
+        ids.push_back(node.get_id());
+    }
+    return ids;
+}
+
+template <typename Fn>
+double ns_per_lookup(const std::vector<std::string>& probes, Fn&& find) {
+    std::size_t found = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& id : probes) {
+        found += find(id) != nullptr;
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    if (found != probes.size()) {
+        std::fprintf(stderr, "warning: %zu/%zu probes found\n", found, probes.size());
+    }
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           static_cast<double>(probes.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t lookups = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200;
+
+    std::printf("%10s %16s %16s\n", "tasks", "dfs ns/lookup", "index ns/lookup");
+
+    for (const std::size_t count : {10000UL, 100000UL, 1000000UL}) {
+        Database db(":memory:");
+        const std::vector<std::string> ids = seed(db, count);
+        TaskService service(db);
+
+        std::mt19937 rng{7};
+        std::uniform_int_distribution<std::size_t> pick(0, ids.size() - 1);
+        std::vector<std::string> probes;
+        for (std::size_t i = 0; i < lookups; ++i) {
+            probes.push_back(ids[pick(rng)]);
+        }
+
+        const TaskNode::Ptr root = service.workspace();
+        const double dfs_ns = ns_per_lookup(probes, [&](const std::string& id) {
+            return dfs_find(root, id);
+        });
+        const double index_ns = ns_per_lookup(probes, [&](const std::string& id) {
+            return service.find_by_id(id);
+        });
+
+        std::printf("%10zu %16.0f %16.0f\n", count, dfs_ns, index_ns);
+    }
+
+    return 0;
+}
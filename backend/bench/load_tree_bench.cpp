@@ -0,0 +1,141 @@
+// load_tree_bench.cpp
+//
+// Startup benchmark: hydrates a synthetic workspace with the legacy
+// per-node loader (SELECT child ids, then get_task_by_id for each) and with
+// Database::load_tree's single recursive scan.
+//
+// Usage: bench_load_tree [task_count] [fanout]
+
+#include "../include/Database.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* kBenchDb = "bench_load_tree.db";
+
+void check(int rc, sqlite3* db, const char* context) {
+    if (rc != SQLITE_OK && rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        throw std::runtime_error(std::string(context) + ": " + sqlite3_errmsg(db));
+    }
+}
+
+// Seeds `count` tasks under ROOT as a tree where every node has `fanout`
+// children, inside one transaction.
+void seed(std::size_t count, std::size_t fanout) {
+    std::remove(kBenchDb);
+    {
+        Database db(kBenchDb);
+        db.ensure_root();
+    }
+
+    sqlite3* raw = nullptr;
+    check(sqlite3_open(kBenchDb, &raw), raw, "open");
+    check(sqlite3_exec(raw, "BEGIN;", nullptr, nullptr, nullptr), raw, "begin");
+
+    sqlite3_stmt* stmt = nullptr;
+    check(sqlite3_prepare_v2(raw,
+        "INSERT INTO tasks (id, parent_id, title, description, status, "
+        "priority, created_at, updated_at) VALUES (?, ?, ?, '', 0, 1, 0, 0);",
+        -1, &stmt, nullptr), raw, "prepare");
+
+    std::vector<std::string> ids{"ROOT"};
+    ids.reserve(count + 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::string& parent = ids[i / fanout];
+        ids.push_back("t" + std::to_string(i));
+        const std::string title = "task " + std::to_string(i);
+
+        sqlite3_bind_text(stmt, 1, ids.back().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, parent.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, title.c_str(), -1, SQLITE_TRANSIENT);
+        check(sqlite3_step(stmt), raw, "step");
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+    check(sqlite3_exec(raw, "COMMIT;", nullptr, nullptr, nullptr), raw, "commit");
+    sqlite3_close(raw);
+}
+
+// The loader TaskService::init used before the bulk scan: one id query per
+// parent plus one get_task_by_id (and prepare) per node.
+TaskNode::Ptr legacy_load_tree(Database& db, sqlite3* raw, const std::string& id) {
+    auto node = std::make_shared<TaskNode>(db.get_task_by_id(id).value());
+
+    std::vector<std::string> child_ids;
+    sqlite3_stmt* stmt = nullptr;
+    check(sqlite3_prepare_v2(raw, "SELECT id FROM tasks WHERE parent_id = ?;",
+                             -1, &stmt, nullptr), raw, "prepare");
+    sqlite3_bind_text(stmt, 1, id.c_str(), -1, SQLITE_TRANSIENT);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        child_ids.emplace_back(
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    }
+    sqlite3_finalize(stmt);
+
+    for (const auto& child_id : child_ids) {
+        node->add_child(legacy_load_tree(db, raw, child_id));
+    }
+    return node;
+}
+
+std::size_t count_nodes(const TaskNode::Ptr& node) {
+    std::size_t total = 1;
+    for (const auto& child : node->get_children()) {
+        total += count_nodes(child);
+    }
+    return total;
+}
+
+double time_ms(const std::function<void()>& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const std::size_t fanout = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 8;
+
+    try {
+        seed(count, fanout);
+
+        Database db(kBenchDb);
+        db.open();
+
+        sqlite3* raw = nullptr;
+        check(sqlite3_open(kBenchDb, &raw), raw, "open");
+
+        std::size_t legacy_nodes = 0;
+        const double legacy_ms = time_ms([&] {
+            legacy_nodes = count_nodes(legacy_load_tree(db, raw, "ROOT"));
+        });
+        sqlite3_close(raw);
+
+        std::size_t bulk_nodes = 0;
+        const double bulk_ms = time_ms([&] {
+            bulk_nodes = count_nodes(db.load_tree("ROOT"));
+        });
+
+        std::printf("tasks=%zu fanout=%zu\n", count, fanout);
+        std::printf("legacy recursive load: %10.1f ms (%zu nodes)\n", legacy_ms, legacy_nodes);
+        std::printf("bulk load_tree:        %10.1f ms (%zu nodes)\n", bulk_ms, bulk_nodes);
+        std::printf("speedup:               %10.1fx\n", legacy_ms / bulk_ms);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "bench failed: %s\n", e.what());
+        return 1;
+    }
+
+    std::remove(kBenchDb);
+    return 0;
+}
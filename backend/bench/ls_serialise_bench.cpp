@@ -0,0 +1,199 @@
+// ls_serialise_bench.cpp
+//
+// Serialises a 100k-child listing the way /api/ls used to (a nlohmann::json
+// DOM per child, then dump()) and the way it does now (TaskListingStream,
+// one bounded chunk at a time), reporting latency and peak heap use above
+// the baseline for each. Outside snapshot mode /api/ls first copies the
+// listing under the lock (ls_by_parent_id), so "copy + stream" counts that
+// copy too. A last row writes the whole listing into one string without a
+// DOM, as /api/tree does.
+//
+// Usage: bench_ls_serialise [children] [runs]
+
+#include "../include/TaskJson.hpp"
+#include "../include/TaskNode.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<std::size_t> live_bytes{0};
+std::atomic<std::size_t> peak_bytes{0};
+
+void track_alloc(void* p) {
+    const std::size_t now = live_bytes += malloc_usable_size(p);
+    std::size_t peak = peak_bytes.load();
+    while (now > peak && !peak_bytes.compare_exchange_weak(peak, now)) {
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    track_alloc(p);
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (p) {
+        live_bytes -= malloc_usable_size(p);
+        std::free(p);
+    }
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+namespace {
+
+struct Result {
+    double ms = 0;
+    std::size_t peak = 0;   // bytes above the live heap at the start
+    std::size_t bytes = 0;  // response size
+};
+
+Result measure(std::size_t runs, const std::function<std::size_t()>& serialise) {
+    Result result;
+    result.ms = 1e300;
+    for (std::size_t i = 0; i < runs; ++i) {
+        const std::size_t base = live_bytes.load();
+        peak_bytes = base;
+
+        const auto start = std::chrono::steady_clock::now();
+        result.bytes = serialise();
+        const auto end = std::chrono::steady_clock::now();
+
+        result.ms = std::min(result.ms,
+            std::chrono::duration<double, std::milli>(end - start).count());
+        result.peak = std::max(result.peak, peak_bytes.load() - base);
+    }
+    return result;
+}
+
+nlohmann::json dom_task(const TaskNode& task) {
+    const TaskNode::Rollup& rollup = task.get_rollup();
+    const auto max = rollup.max_priority();
+    return {
+        {"id", task.get_id()},
+        {"title", task.get_title()},
+        {"description", task.get_description()},
+        {"status", task.get_status()},
+        {"priority", task.get_priority()},
+        {"created_at", task.get_created_at()},
+        {"last_updated_at", task.get_updated_at()},
+        {"rollup", {
+            {"descendants", rollup.descendants},
+            {"by_status", rollup.by_status},
+            {"by_priority", rollup.by_priority},
+            {"max_priority", max ? nlohmann::json(*max) : nlohmann::json(nullptr)},
+            {"completion_percent", rollup.completion_percent()}
+        }}
+    };
+}
+
+std::size_t dom_dump(const std::vector<TaskNode::Ptr>& children) {
+    nlohmann::json out = nlohmann::json::array();
+    for (const auto& child : children) {
+        out.push_back(dom_task(*child));
+    }
+    return out.dump().size();
+}
+
+// Stands in for the socket: bytes are counted and the chunk reused.
+std::size_t streamed(const std::vector<TaskNode::Ptr>& children) {
+    TaskListingStream stream(children);
+    std::string chunk;
+    std::size_t bytes = 0;
+    while (stream.next(chunk)) {
+        bytes += chunk.size();
+    }
+    return bytes;
+}
+
+// What /api/ls does outside snapshot mode: detached copies, then chunks.
+std::size_t copied_then_streamed(const std::vector<TaskNode::Ptr>& children) {
+    std::vector<TaskNode::Ptr> copies;
+    copies.reserve(children.size());
+    for (const auto& child : children) {
+        copies.push_back(child->clone_detached());
+    }
+    return streamed(copies);
+}
+
+std::size_t single_buffer(const std::vector<TaskNode::Ptr>& children) {
+    std::string out = "[";
+    for (std::size_t i = 0; i < children.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        task_json::append_task(out, *children[i]);
+    }
+    out.push_back(']');
+    return out.size();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const std::size_t runs = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+
+    std::vector<TaskNode::Ptr> children;
+    children.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        children.push_back(std::make_shared<TaskNode>(
+            "task " + std::to_string(i),
+            "description of task " + std::to_string(i) + " with a \"quote\"\n"));
+    }
+
+    // The streamed bytes must be exactly what the DOM produced.
+    {
+        std::string joined;
+        TaskListingStream stream(children);
+        std::string chunk;
+        while (stream.next(chunk)) {
+            joined += chunk;
+        }
+        nlohmann::json dom = nlohmann::json::array();
+        for (const auto& child : children) {
+            dom.push_back(dom_task(*child));
+        }
+        // The DOM sorts keys; compare parsed values instead of bytes.
+        if (nlohmann::json::parse(joined) != dom) {
+            std::fprintf(stderr, "error: streamed output differs from the DOM\n");
+            return 1;
+        }
+    }
+
+    const Result dom = measure(runs, [&] { return dom_dump(children); });
+    const Result stream = measure(runs, [&] { return streamed(children); });
+    const Result copied = measure(runs, [&] { return copied_then_streamed(children); });
+    const Result single = measure(runs, [&] { return single_buffer(children); });
+
+    std::printf("%zu children, %zu bytes of JSON, best of %zu runs\n\n",
+                count, stream.bytes, runs);
+    std::printf("%-16s %12s %16s\n", "serialiser", "ms", "peak heap KiB");
+    std::printf("%-16s %12.2f %16zu\n", "dom + dump", dom.ms, dom.peak / 1024);
+    std::printf("%-16s %12.2f %16zu\n", "stream chunks", stream.ms, stream.peak / 1024);
+    std::printf("%-16s %12.2f %16zu\n", "copy + stream", copied.ms, copied.peak / 1024);
+    std::printf("%-16s %12.2f %16zu\n", "single buffer", single.ms, single.peak / 1024);
+
+    return 0;
+}
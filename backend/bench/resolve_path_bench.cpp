@@ -0,0 +1,112 @@
+// resolve_path_bench.cpp
+//
+// Path resolution over synthetic wide and deep trees: the linear sibling
+// scan find_child_by_title used to do at every segment, against the title
+// index wide nodes now keep. Each tree is a single path of `depth` levels
+// where every level has `width` siblings; the probe resolves the last
+// sibling at every level (the worst case for a scan).
+//
+// Usage: bench_resolve_path [resolves_per_shape]
+
+#include "../include/TaskNode.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// The lookup resolve_path used before the index: scan every sibling.
+TaskNode::Ptr scan_resolve(const TaskNode::Ptr& root, std::string_view path) {
+    TaskNode::Ptr current = root;
+    std::size_t pos = 1;
+    while (pos < path.size()) {
+        const std::size_t slash = path.find('/', pos);
+        const std::string_view segment = path.substr(pos, slash - pos);
+
+        TaskNode::Ptr next;
+        for (const auto& c : current->get_children()) {
+            if (c->get_title() == segment) {
+                next = c;
+                break;
+            }
+        }
+        if (!next) {
+            return nullptr;
+        }
+        current = next;
+        pos = slash == std::string_view::npos ? path.size() : slash + 1;
+    }
+    return current;
+}
+
+struct Shape {
+    std::size_t depth;
+    std::size_t width;
+};
+
+// Builds the tree and returns the path of its deepest probe node.
+std::string build(const TaskNode::Ptr& root, Shape shape) {
+    std::string path;
+    TaskNode::Ptr level = root;
+    for (std::size_t d = 0; d < shape.depth; ++d) {
+        TaskNode::Ptr last;
+        for (std::size_t w = 0; w < shape.width; ++w) {
+            last = TaskNode::create_child(
+                level, "node " + std::to_string(d) + "." + std::to_string(w));
+        }
+        path += "/" + last->get_title();
+        level = last;
+    }
+    return path;
+}
+
+template <typename Fn>
+double ns_per_resolve(std::size_t resolves, Fn&& resolve) {
+    std::size_t found = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < resolves; ++i) {
+        found += resolve() != nullptr;
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    if (found != resolves) {
+        std::fprintf(stderr, "warning: %zu/%zu resolves found\n", found, resolves);
+    }
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           static_cast<double>(resolves);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t resolves = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+
+    const Shape shapes[] = {
+        {1, 10}, {1, 1000}, {1, 100000},     // wide
+        {64, 2}, {1000, 1},                  // deep
+        {16, 1000}, {64, 200},               // wide and deep
+    };
+
+    std::printf("%6s %8s %16s %16s\n", "depth", "width", "scan ns/path", "index ns/path");
+
+    for (const Shape shape : shapes) {
+        auto root = std::make_shared<TaskNode>(
+            "ROOT", "/", "", TaskStatus::TODO, TaskPriority::MEDIUM, 0, 0);
+        const std::string path = build(root, shape);
+
+        const double scan_ns = ns_per_resolve(resolves, [&] {
+            return scan_resolve(root, path);
+        });
+        const double index_ns = ns_per_resolve(resolves, [&] {
+            return resolve_path(root, path);
+        });
+
+        std::printf("%6zu %8zu %16.0f %16.0f\n", shape.depth, shape.width, scan_ns, index_ns);
+    }
+
+    return 0;
+}
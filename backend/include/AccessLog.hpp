@@ -0,0 +1,123 @@
+#ifndef TASKFARMER_V2_ACCESSLOG_HPP
+#define TASKFARMER_V2_ACCESSLOG_HPP
+
+#include "Metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+struct AccessLogConfig {
+    // Destination of the JSON lines. Not owned; must outlive the log.
+    std::FILE* out = stdout;
+    // Fraction of requests logged, in [0, 1]. 5xx responses are always
+    // logged.
+    double sample_rate = 1.0;
+    // Entries each worker thread can have waiting for the writer. Rounded
+    // up to a power of two. Records that find the buffer full are dropped
+    // and counted rather than waited on.
+    std::size_t buffer_entries = 1024;
+    // How often the writer thread drains the buffers.
+    std::chrono::milliseconds flush_interval{50};
+};
+
+// Access log that keeps file I/O off the request threads.
+//
+// Each thread that calls record() gets its own single-producer ring of
+// fixed-size entries, so recording is a copy into the ring and two atomic
+// stores, with no lock and no allocation after the thread's first call. A
+// background thread drains every ring on flush_interval, formats the
+// entries as JSON lines and writes them with one fwrite. A slow or blocked
+// destination therefore stalls only that thread; once a ring fills, further
+// records from its thread are dropped and counted.
+//
+// Each line is
+//   {"ts_ms":..,"method":"GET","path":"/api/ls","status":200,
+//    "duration_us":..,"bytes":..,"remote":"127.0.0.1"}
+// where path is truncated to kMaxPath bytes and bytes is the response body
+// size (0 for streamed responses).
+class AccessLog {
+public:
+    static constexpr std::size_t kMaxMethod = 8;
+    static constexpr std::size_t kMaxPath = 192;
+    static constexpr std::size_t kMaxRemote = 46;  // INET6_ADDRSTRLEN
+
+    // Process-wide totals, shared with the /metrics counters.
+    struct Stats {
+        std::uint64_t written = 0;
+        std::uint64_t dropped = 0;
+        std::uint64_t sampled_out = 0;
+    };
+
+    explicit AccessLog(AccessLogConfig config = {});
+
+    // Writes every recorded entry, then stops the writer thread.
+    ~AccessLog();
+
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+
+    void record(std::string_view method,
+                std::string_view path,
+                int status,
+                std::chrono::steady_clock::duration duration,
+                std::size_t bytes,
+                std::string_view remote);
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::int64_t ts_ms;
+        std::uint64_t duration_us;
+        std::uint64_t bytes;
+        int status;
+        std::uint8_t method_len;
+        std::uint8_t path_len;
+        std::uint8_t remote_len;
+        char method[kMaxMethod];
+        char path[kMaxPath];
+        char remote[kMaxRemote];
+    };
+
+    // Single producer (the owning thread), single consumer (the writer).
+    struct Ring {
+        explicit Ring(std::size_t capacity) : entries(capacity), mask(capacity - 1) {}
+
+        std::vector<Entry> entries;
+        const std::size_t mask;
+        alignas(64) std::atomic<std::size_t> head{0};  // next to read
+        alignas(64) std::atomic<std::size_t> tail{0};  // next to write
+    };
+
+    AccessLogConfig config_;
+    std::size_t ring_capacity_;
+    std::uint64_t sample_threshold_;  // log when a random 64-bit draw is below
+    std::uint64_t id_;                // tells this log's rings apart per thread
+
+    std::mutex rings_mutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+
+    metrics::Counter& written_;
+    metrics::Counter& dropped_;
+    metrics::Counter& sampled_out_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::thread writer_;
+
+    Ring& local_ring();
+    void run();
+    // Formats and writes every waiting entry. Only called by writer_.
+    void drain(std::string& buffer);
+};
+
+#endif //TASKFARMER_V2_ACCESSLOG_HPP
@@ -0,0 +1,138 @@
+#ifndef TASKFARMER_V2_ADMISSIONCONTROLLER_HPP
+#define TASKFARMER_V2_ADMISSIONCONTROLLER_HPP
+
+#include "Metrics.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+struct AdmissionConfig {
+    bool enabled = true;
+
+    // Workers kept free of writes, so reads always have somewhere to run.
+    // 0 picks a quarter of the workers (at least one).
+    std::size_t read_reserve = 0;
+    // Concurrent bulk requests (batch create, subtree delete).
+    std::size_t bulk_concurrency = 2;
+    // Of the workers outside read_reserve, how many writes may spend
+    // waiting for a slot; the rest run writes. 0 picks half of them (none
+    // when there is only one).
+    std::size_t write_waiting = 0;
+    // Requests that may wait for admission on one route; further ones get
+    // 429 straight away, as do writes once write_waiting writes wait.
+    std::size_t max_waiting = 64;
+
+    // Longest a request may wait, counting its connection's time in the
+    // worker queue, before it is answered with 503 instead of being run.
+    std::chrono::milliseconds read_budget{250};
+    std::chrono::milliseconds write_budget{2000};
+};
+
+// Gate between routing and the route handlers.
+//
+// Each route belongs to a class:
+//   READ   cheap lookups; may use every worker, so they never wait here.
+//   WRITE  single-task writes. Writes, WRITE and BULK together, may hold
+//          the workers outside read_reserve and no more, so they can never
+//          occupy every worker while reads queue behind them. Those
+//          workers are split between running writes and write_waiting
+//          writes waiting for a slot, since a waiting request holds its
+//          worker too.
+//   BULK   requests that can hold the TaskService lock for long; also
+//          limited to bulk_concurrency at once.
+//   EXEMPT never gated (health checks, /metrics).
+// A write that cannot start at once waits, up to its class's budget, for
+// a slot; once write_waiting writes (or max_waiting requests on its route)
+// are already waiting it is turned away with QUEUE_FULL instead. Any
+// request whose connection already spent its budget in the worker queue
+// is turned away without running.
+class AdmissionController {
+public:
+    enum class RouteClass { EXEMPT, READ, WRITE, BULK };
+    enum class Outcome { ADMITTED, QUEUE_FULL, TIMED_OUT };
+
+private:
+    struct Route {
+        RouteClass route_class = RouteClass::EXEMPT;
+        std::size_t limit = 0;
+        std::chrono::steady_clock::duration budget{};
+
+        // Guarded by mutex_.
+        std::size_t in_flight = 0;
+        std::size_t waiting = 0;
+
+        metrics::Histogram* wait = nullptr;
+        metrics::Counter* queue_full = nullptr;
+        metrics::Counter* timed_out = nullptr;
+        metrics::Gauge* in_flight_gauge = nullptr;
+    };
+
+public:
+    // Holds an admitted request's slot until destroyed or reset.
+    class Ticket {
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept;
+        Ticket& operator=(Ticket&& other) noexcept;
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        ~Ticket() { reset(); }
+
+        void reset();
+
+    private:
+        friend class AdmissionController;
+
+        Ticket(AdmissionController* owner, Route* route) : owner_(owner), route_(route) {}
+
+        AdmissionController* owner_ = nullptr;
+        Route* route_ = nullptr;
+    };
+
+    AdmissionController(AdmissionConfig config, std::size_t workers);
+
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // Registers `key` (e.g. "GET /api/ls"). Routes must all be added
+    // before the first admit.
+    void add_route(std::string key, RouteClass route_class);
+
+    // Waits for a slot on `key`'s route. `queued` is how long the request
+    // already waited before reaching the controller. Unknown and EXEMPT
+    // routes are always admitted, with an empty ticket.
+    Outcome admit(std::string_view key, std::chrono::steady_clock::duration queued, Ticket& ticket);
+
+private:
+    AdmissionConfig config_;
+    std::size_t workers_;
+    std::size_t write_running_;   // of the workers outside read_reserve,
+    std::size_t write_waiting_;   // those for running and waiting writes
+
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view key) const {
+            return std::hash<std::string_view>{}(key);
+        }
+    };
+
+    // Built by add_route before serving; only the counters in each Route
+    // change afterwards.
+    std::unordered_map<std::string, Route, KeyHash, std::equal_to<>> routes_;
+
+    std::mutex mutex_;
+    std::condition_variable released_;
+    std::size_t writes_in_flight_ = 0;
+    std::size_t writes_waiting_ = 0;
+
+    bool can_start(const Route& route) const;
+    void release(Route& route);
+};
+
+#endif //TASKFARMER_V2_ADMISSIONCONTROLLER_HPP
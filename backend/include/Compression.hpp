@@ -0,0 +1,75 @@
+#ifndef TASKFARMER_V2_COMPRESSION_HPP
+#define TASKFARMER_V2_COMPRESSION_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// HTTP response compression. gzip is always built in; brotli and zstd when
+// CMake finds their libraries (TASKFARMER_WITH_BROTLI, TASKFARMER_WITH_ZSTD).
+namespace compression {
+
+enum class ContentEncoding { IDENTITY, GZIP, BROTLI, ZSTD };
+
+struct CompressionConfig {
+    bool enabled = true;
+    // Smaller responses are sent as they are; below a few hundred bytes
+    // the framing overhead eats most of the gain.
+    std::size_t min_bytes = 1024;
+    int gzip_level = 6;        // 1..9
+    int brotli_quality = 5;    // 0..11
+    int zstd_level = 3;        // 1..19
+};
+
+// Throws std::runtime_error for out-of-range levels.
+void validate(const CompressionConfig& config);
+
+// The token for Content-Encoding, e.g. "gzip".
+std::string_view encoding_name(ContentEncoding encoding);
+
+// Picks the encoding for an Accept-Encoding header value: the highest
+// q-value among the built-in encodings, preferring zstd, then br, then
+// gzip on ties. "*" stands for any encoding not listed, and q=0 rules an
+// encoding out. IDENTITY if nothing acceptable is built in.
+ContentEncoding negotiate(std::string_view accept_encoding);
+
+// Whether a Content-Type is worth compressing (JSON and text).
+bool compressible(std::string_view content_type);
+
+// One compressed stream. Feed it with update() and end it with finish(),
+// which also records the stream's input and output bytes and the thread
+// CPU time spent compressing in /metrics, by encoding.
+class Compressor {
+public:
+    Compressor(ContentEncoding encoding, const CompressionConfig& config);
+    ~Compressor();
+
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    // Appends whatever compressed output `input` produces to `out`; may
+    // append nothing while the encoder buffers.
+    void update(std::string_view input, std::string& out);
+
+    // Appends the rest of the stream to `out`. Call once.
+    void finish(std::string& out);
+
+    class Encoder;
+
+private:
+    ContentEncoding encoding_;
+    std::unique_ptr<Encoder> encoder_;
+    std::size_t bytes_in_ = 0;
+    std::size_t bytes_out_ = 0;
+    std::chrono::nanoseconds cpu_{0};
+};
+
+// Compresses `input` in one go.
+std::string compress(ContentEncoding encoding, const CompressionConfig& config,
+                     std::string_view input);
+
+} // namespace compression
+
+#endif //TASKFARMER_V2_COMPRESSION_HPP
@@ -1,6 +1,7 @@
 #ifndef TASKFARMER_V2_DATABASE_HPP
 #define TASKFARMER_V2_DATABASE_HPP
 
+#include "Statement.hpp"
 #include "TaskNode.hpp"
 
 #include <sqlite3.h>
@@ -12,14 +13,23 @@
 
 #include "User.hpp"
 
+// READ_ONLY connections are opened with SQLITE_OPEN_READONLY and
+// query_only, never create or migrate the schema, and are meant to be used
+// by one thread at a time (see ReadConnectionPool).
+enum class DatabaseAccess { READ_WRITE, READ_ONLY };
+
 class Database {
 public:
-    explicit Database(std::string db_path);
+    explicit Database(std::string db_path,
+                      DatabaseAccess access = DatabaseAccess::READ_WRITE);
     ~Database();
 
     Database(const Database&) = delete;
     Database& operator=(const Database&) = delete;
 
+    const std::string& path() const { return db_path_; }
+    bool read_only() const { return access_ == DatabaseAccess::READ_ONLY; }
+
     // Connection + schema
     void open();
     void close();
@@ -34,7 +44,9 @@ public:
     // Requires that the DB can be opened; this function calls ensure_root().
     TaskNode load_root();
 
-    // Persists a TaskNode under the given parent_id.
+    // Persists a TaskNode under the given parent_id. Every field, including
+    // status, priority and both timestamps, is taken from the node, so one
+    // INSERT is the complete write.
     bool insert_task(const TaskNode& node, const std::string& parent_id);
 
     // Retrieves a row by id (hydrated TaskNode).
@@ -45,37 +57,121 @@ public:
     std::vector<TaskNode> list_children(std::string_view parent_id) const;
 
     // Updates mutable fields for the given node (matched by node.get_id()).
+    // Returns false if no task has that id.
     bool update_task_fields(const TaskNode& node);
 
     // Delete operations (to be implemented later)
     bool delete_task_only(std::string_view id);
+
+    // Deletes the task and all its descendants with one range delete over
+    // the materialised path index. Returns false if the task does not exist.
     bool delete_subtree(std::string_view id);
 
+    // Ancestry, answered from the materialised id path stored on every row
+    // ("ROOT/<id>/<id>/"), kept by insert_task and indexed by idx_tasks_path.
+    std::optional<std::string> get_task_id_path(std::string_view id) const;
+
+    // Number of descendants (not counting the task itself).
+    std::size_t count_descendants(std::string_view id) const;
+
+    // True if ancestor_id is a strict ancestor of descendant_id.
+    bool is_ancestor_of(std::string_view ancestor_id,
+                        std::string_view descendant_id) const;
+
+    // Title path, e.g. "/Tetris Clone/Game Logic/", or nullopt if the task
+    // does not exist.
+    std::optional<std::string> render_path(std::string_view id) const;
+
     // Loads the entire task tree structure into memory, starting from root_id.
+    // Reads the tasks table in a single scan and links each node to its
+    // parent by id, instead of issuing one query per node.
     // Typical usage: ensure_root(); auto root = load_tree("ROOT");
     TaskNode::Ptr load_tree(std::string_view root_id = "ROOT");
 
-    // Helper: creates TaskNode in memory and persists it under parent_id.
+    // Helper: creates TaskNode in memory and persists it under parent_id
+    // with a single INSERT carrying the full field set.
     TaskNode create_task_under(std::string_view parent_id,
                                std::string title,
-                               std::string description = "");
+                               std::string description = "",
+                               TaskStatus status = TaskStatus::TODO,
+                               TaskPriority priority = TaskPriority::MEDIUM);
 
 
     bool insert_user_role(std::string_view user_id, std::string_view role_string);
 
     bool insert_user(std::string_view id, std::string_view name);
 
+    // Transactions. BEGIN IMMEDIATE takes the write lock up front so a
+    // transaction never has to upgrade from a read lock half way through.
+    void begin();
+    void commit();
+    void rollback();
+
+    // Savepoints nest inside a transaction, letting one failing write be
+    // undone without discarding the rest of a group commit.
+    void savepoint(std::string_view name);
+    void release_savepoint(std::string_view name);
+    void rollback_to_savepoint(std::string_view name);
+
+    // One ranked full-text match; lower score is a better match.
+    struct SearchHit {
+        TaskNode task;
+        std::string parent_id;
+        double score;
+    };
+
+    // Ranked full-text search over task titles and descriptions. `text` is
+    // plain user input; its terms are ANDed. When more than
+    // kSearchRankWindow tasks match, only the most recently inserted
+    // kSearchRankWindow of them are ranked and returned: older matches are
+    // left out even if they would rank higher, and pages past the window
+    // are empty. Every page is taken from that one ranking, so paging never
+    // repeats or skips a hit.
+    static constexpr std::size_t kSearchRankWindow = 2000;
+
+    std::vector<SearchHit> search_tasks(std::string_view text,
+                                        std::size_t limit,
+                                        std::size_t offset = 0) const;
+
+    // Re-indexes every task. The index is keyed by tasks.rowid, which VACUUM
+    // may renumber, so run this after a VACUUM.
+    void rebuild_search_index();
+
+    // Hit/miss counters of the prepared-statement cache.
+    StatementCache::Stats statement_cache_stats() const;
 
 private:
     std::string db_path_;
+    DatabaseAccess access_;
     sqlite3* db_ = nullptr;
+    bool schema_initialised_ = false;
+
+    // Prepared statements reused across calls; finalized in close().
+    mutable StatementCache statements_;
+
+    // Borrows the cached statement for `sql` (preparing it on first use).
+    // `context` prefixes any error thrown through the returned guard.
+    Statement prepare(std::string_view sql, std::string_view context) const;
 
     void exec(std::string_view sql) const;
 
-    static void throw_sqlite(sqlite3* db, int rc, std::string_view context);
+    // PRAGMA user_version of the current schema.
+    //   1: tasks.path (materialised id path)
+    static constexpr int kSchemaVersion = 1;
+
+    // Brings databases created by older builds up to kSchemaVersion.
+    void migrate_schema();
+
+    // Exclusive upper bound of the id paths under `path`.
+    static std::string subtree_upper_bound(std::string_view path);
+
+    // Turns free text into a safe FTS5 MATCH expression.
+    static std::string fts_query(std::string_view text);
 
-    // Not used in current implementation (load_tree does recursion inline).
-    // void load_children_recursive(const TaskNode::Ptr& parent) const;
+    // Builds a TaskNode from the current row of a statement whose first seven
+    // columns are: id, title, description, status, priority, created_at,
+    // updated_at.
+    static TaskNode hydrate_task(sqlite3_stmt* stmt);
 };
 
 #endif
\ No newline at end of file
@@ -2,26 +2,85 @@
 #define TASKFARMER_V2_HTTPSERVER_HPP
 
 #include <httplib.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include "AccessLog.hpp"
+#include "AdmissionController.hpp"
+#include "Compression.hpp"
+#include "Metrics.hpp"
 #include "TaskService.hpp"
 
+struct HttpServerConfig {
+    std::string host = "0.0.0.0";
+    int port = 8080;
+
+    // Workers serving connections; a connection holds its worker for as
+    // long as it is kept alive. Defaults to httplib's own pool size.
+    std::size_t worker_threads =
+        std::max<std::size_t>(8, std::max(1u, std::thread::hardware_concurrency()) - 1);
+    // Connections that may wait for a worker before new ones are answered
+    // with 503 (see WorkerPool). 0 queues without bound.
+    std::size_t max_queued = 256;
+
+    // Requests served on one connection before it is closed, and how long
+    // an idle kept-alive connection may hold its worker.
+    std::size_t keep_alive_max_count = 5;
+    std::chrono::seconds keep_alive_timeout{5};
+
+    std::chrono::seconds read_timeout{5};
+    std::chrono::seconds write_timeout{5};
+
+    // Largest request body accepted; larger ones get 413.
+    std::size_t payload_max_bytes = 64 * 1024 * 1024;
+
+    AccessLogConfig access_log;
+    AdmissionConfig admission;
+
+    // gzip/br/zstd for JSON and text responses the client accepts.
+    compression::CompressionConfig compression;
+};
+
 class HttpServer {
 public:
-    HttpServer(std::string host, int port, TaskService& service);
+    HttpServer(HttpServerConfig config, TaskService& service);
 
     void setup_routes();
 
     void run();
 
 private:
-    std::string host_;
-    int port_;
+    HttpServerConfig config_;
     TaskService& service_;
 
     httplib::Server server_;
+    AccessLog access_log_;
+    AdmissionController admission_;
+
+    // Request counters by status class (1xx..5xx) and latency for one
+    // route. Built once in setup_routes, with the admission routes, and
+    // read-only afterwards.
+    struct RouteMetrics {
+        std::array<metrics::Counter*, 5> responses{};
+        metrics::Histogram* duration = nullptr;
+    };
+
+    // Keyed by "METHOD /path"; requests for unknown paths are counted
+    // under other_route_ so scanners cannot grow the label set.
+    std::unordered_map<std::string, RouteMetrics> route_metrics_;
+    RouteMetrics other_route_;
 
     void register_health_endpoint();
     void register_api_endpoint();
+    void register_metrics_endpoint();
+
+    void register_route_table();
+    void record_request(const httplib::Request& req,
+                        const httplib::Response& res,
+                        std::chrono::steady_clock::duration elapsed);
 
     static void set_json(
         httplib::Response& res,
@@ -0,0 +1,145 @@
+#ifndef TASKFARMER_V2_METRICS_HPP
+#define TASKFARMER_V2_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Process-wide metrics in the Prometheus text format.
+//
+// Counters and histograms are split into kShards cache-line-sized shards.
+// Each thread is given one shard when it first records and only ever adds
+// to that one, with relaxed atomics, so recording takes no lock and up to
+// kShards threads never share a cache line. Scrapes sum the shards.
+//
+// The registry's mutex is only taken to create a metric and to render; hot
+// paths keep the returned reference.
+namespace metrics {
+
+constexpr std::size_t kShards = 16;
+
+// The calling thread's shard, fixed for the life of the thread.
+std::size_t shard_index();
+
+class Counter {
+public:
+    void add(std::uint64_t n = 1) {
+        shards_[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    std::uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+    std::array<Shard, kShards> shards_;
+};
+
+// A value that goes up and down, e.g. a queue depth. Set far less often
+// than counters are bumped, so it is a single atomic.
+class Gauge {
+public:
+    void set(std::int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(std::int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    std::int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::int64_t> value_{0};
+};
+
+// Latency histogram with fixed bucket bounds from 50 µs to 10 s.
+class Histogram {
+public:
+    static constexpr std::size_t kBuckets = 16;
+    static constexpr std::array<std::uint64_t, kBuckets> kBoundsNs = {
+        50'000, 100'000, 250'000, 500'000,
+        1'000'000, 2'500'000, 5'000'000, 10'000'000,
+        25'000'000, 50'000'000, 100'000'000, 250'000'000,
+        500'000'000, 1'000'000'000, 2'500'000'000, 10'000'000'000,
+    };
+
+    struct Snapshot {
+        std::array<std::uint64_t, kBuckets + 1> buckets{};  // last is +Inf
+        std::uint64_t count = 0;
+        std::uint64_t sum_ns = 0;
+    };
+
+    void observe_ns(std::uint64_t ns);
+
+    void observe(std::chrono::steady_clock::duration elapsed) {
+        observe_ns(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    Snapshot snapshot() const;
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, kBuckets + 1> buckets{};
+        std::atomic<std::uint64_t> sum_ns{0};
+    };
+    std::array<Shard, kShards> shards_;
+};
+
+// `{k1="v1",k2="v2"}` with values escaped for the exposition format.
+std::string labels(std::initializer_list<std::pair<std::string_view, std::string_view>> pairs);
+
+// Appends a gauge with its HELP and TYPE lines, for values sampled at
+// scrape time rather than recorded as they happen. One sample per name.
+void append_gauge(std::string& out, std::string_view name, std::string_view help,
+                  double value, std::string_view label_set = {});
+
+// As append_gauge, for monotonic totals kept elsewhere (e.g. a Stats struct).
+void append_counter(std::string& out, std::string_view name, std::string_view help,
+                    double value, std::string_view label_set = {});
+
+class Registry {
+public:
+    // Return the metric for (name, label_set), creating it on first use.
+    // References stay valid for the life of the registry.
+    Counter& counter(std::string_view name, std::string_view help,
+                     std::string_view label_set = {});
+    Gauge& gauge(std::string_view name, std::string_view help,
+                 std::string_view label_set = {});
+    Histogram& histogram(std::string_view name, std::string_view help,
+                         std::string_view label_set = {});
+
+    // Every registered metric in the exposition format, families and
+    // series sorted by name.
+    void render(std::string& out) const;
+
+private:
+    template <typename Metric>
+    struct Family {
+        std::string help;
+        std::map<std::string, std::unique_ptr<Metric>, std::less<>> series;
+    };
+
+    template <typename Metric>
+    using Families = std::map<std::string, Family<Metric>, std::less<>>;
+
+    mutable std::mutex mutex_;
+    Families<Counter> counters_;
+    Families<Gauge> gauges_;
+    Families<Histogram> histograms_;
+
+    template <typename Metric>
+    static Metric& get_or_create(Families<Metric>& families, std::string_view name,
+                                 std::string_view help, std::string_view label_set);
+};
+
+Registry& registry();
+
+} // namespace metrics
+
+#endif //TASKFARMER_V2_METRICS_HPP
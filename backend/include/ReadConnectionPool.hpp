@@ -0,0 +1,80 @@
+#ifndef TASKFARMER_V2_READCONNECTIONPOOL_HPP
+#define TASKFARMER_V2_READCONNECTIONPOOL_HPP
+
+#include "Database.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Read-only connections to the same database file as the writer.
+// Under WAL each of them reads the last committed state without taking
+// the write lock, so database reads such as search run alongside the
+// journal's commits instead of queueing on the writer's connection. Every
+// connection keeps its own StatementCache, and is lent to one thread at a
+// time; acquire() waits while all of them are out.
+//
+// Connections are opened on first use, so the writer must have created
+// the schema by then.
+class ReadConnectionPool {
+public:
+    struct Stats {
+        std::size_t size = 0;
+        std::size_t in_use = 0;
+        std::uint64_t acquired = 0;
+        // Acquires that found every connection lent out, and the total
+        // time they spent waiting.
+        std::uint64_t waits = 0;
+        std::uint64_t wait_ns = 0;
+    };
+
+    // Returns the connection to the pool on destruction.
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&&) = delete;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        Database& operator*() const { return *db_; }
+        Database* operator->() const { return db_; }
+
+    private:
+        friend class ReadConnectionPool;
+
+        Lease(ReadConnectionPool* pool, Database* db) : pool_(pool), db_(db) {}
+
+        ReadConnectionPool* pool_;
+        Database* db_;
+    };
+
+    ReadConnectionPool(std::string db_path, std::size_t size);
+
+    ReadConnectionPool(const ReadConnectionPool&) = delete;
+    ReadConnectionPool& operator=(const ReadConnectionPool&) = delete;
+
+    // False for databases other connections cannot open: ":memory:",
+    // temporary ("") and in-memory URI databases.
+    static bool shareable(std::string_view db_path);
+
+    Lease acquire();
+
+    Stats stats() const;
+
+private:
+    std::vector<std::unique_ptr<Database>> connections_;
+    std::vector<Database*> idle_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    Stats stats_;
+
+    void release(Database* db);
+};
+
+#endif //TASKFARMER_V2_READCONNECTIONPOOL_HPP
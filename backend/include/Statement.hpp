@@ -0,0 +1,125 @@
+#ifndef TASKFARMER_V2_STATEMENT_HPP
+#define TASKFARMER_V2_STATEMENT_HPP
+
+#include "Metrics.hpp"
+
+#include <sqlite3.h>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class StatementCache;
+struct CachedStatement;
+
+// RAII guard around a prepared statement.
+// A statement borrowed from a StatementCache is reset, has its bindings
+// cleared and is handed back to the cache on destruction; any other
+// statement is finalized. Every failing sqlite call throws a
+// std::runtime_error prefixed with `context`, so callers no longer need
+// their own finalize-on-error paths.
+//
+// The time from the first step to the guard going away, which includes the
+// caller's handling of each row, is recorded in `timing`.
+class Statement {
+public:
+    Statement(sqlite3* db,
+              sqlite3_stmt* stmt,
+              StatementCache* owner,
+              CachedStatement* entry,
+              std::string_view context,
+              metrics::Histogram* timing);
+    ~Statement();
+
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+
+    Statement(Statement&& other) noexcept;
+    Statement& operator=(Statement&& other) = delete;
+
+    sqlite3_stmt* get() const { return stmt_; }
+
+    // Bind helpers; indexes are 1-based as in sqlite3_bind_*.
+    void bind_text(int index, std::string_view value);
+    void bind_int(int index, int value);
+    void bind_int64(int index, sqlite3_int64 value);
+    void bind_null(int index);
+
+    // Steps once. Returns true when a row is available and false once the
+    // statement is done.
+    bool step();
+
+    // Steps a statement that must not produce rows (INSERT/UPDATE/DELETE).
+    void run();
+
+private:
+    sqlite3* db_ = nullptr;
+    sqlite3_stmt* stmt_ = nullptr;
+    StatementCache* owner_ = nullptr;
+    CachedStatement* entry_ = nullptr;
+    std::string_view context_;
+    metrics::Histogram* timing_ = nullptr;
+    std::chrono::steady_clock::time_point started_{};
+
+    void check(int rc, std::string_view what) const;
+    void start_timing();
+};
+
+struct CachedStatement {
+    sqlite3_stmt* stmt = nullptr;
+    bool in_use = false;
+    bool retired = false;
+    metrics::Histogram* timing = nullptr;  // resolved once, on prepare
+};
+
+// Per-connection cache of prepared statements keyed by their SQL text.
+// A cached statement is lent to one Statement guard at a time; if the same
+// query is needed again while it is still borrowed (e.g. by another
+// thread), a one-off statement is prepared and finalized instead.
+class StatementCache {
+public:
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t size = 0;
+    };
+
+    StatementCache() = default;
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // Returns a guard for `sql` on `db`, preparing it on first use.
+    Statement acquire(sqlite3* db, std::string_view sql, std::string_view context);
+
+    // Finalizes every cached statement. Must be called before the owning
+    // connection is closed; borrowed statements are finalized when their
+    // guard goes away.
+    void clear();
+
+    Stats stats() const;
+
+private:
+    friend class Statement;
+
+    struct SqlHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view sql) const {
+            return std::hash<std::string_view>{}(sql);
+        }
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, CachedStatement, SqlHash, std::equal_to<>>
+        entries_;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+
+    void release(CachedStatement* entry);
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef TASKFARMER_V2_TASKID_HPP
+#define TASKFARMER_V2_TASKID_HPP
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// A 64-bit id, minted and hashed as one integer. Tasks still carry it as
+// 16 lowercase hex digits: the tasks table keys on TEXT id and parent_id,
+// the "ROOT" parent is not hex, and the tree, its indexes and the HTTP API
+// all look tasks up by that text, so existing rows and URLs keep working
+// without a table rebuild. Ordered ids sort the same as text, which gives
+// the TEXT primary key the same right-edge inserts an INTEGER key would.
+class TaskId {
+public:
+    static constexpr std::size_t kHexLength = 16;
+
+    constexpr TaskId() = default;
+    constexpr explicit TaskId(std::uint64_t value) : value_(value) {}
+
+    // 64 random bits from a per-thread generator; no locking, no streams.
+    static TaskId generate();
+
+    // Time-ordered id: two tag bits set to 1, Unix milliseconds in the
+    // next kTimeBits, then a sequence that starts at a random point each
+    // millisecond. Ids from one process strictly increase, even across
+    // threads and if the clock steps back. The hex form is fixed-width, so
+    // they sort the same as text, and the tag makes it start with c-f,
+    // above "ROOT" and most random ids, so new rows land at the right edge
+    // of the id index.
+    static TaskId generate_ordered();
+
+    static constexpr unsigned kTagBits = 2;
+    static constexpr unsigned kTimeBits = 42;  // milliseconds until 2109
+
+    // Parses exactly kHexLength hex digits (either case). Returns nullopt
+    // for anything else, including the "ROOT" id.
+    static std::optional<TaskId> from_hex(std::string_view hex);
+
+    std::string to_hex() const;
+    void append_hex(std::string& out) const;
+
+    constexpr std::uint64_t value() const { return value_; }
+
+    friend constexpr bool operator==(TaskId, TaskId) = default;
+    friend constexpr auto operator<=>(TaskId, TaskId) = default;
+
+private:
+    std::uint64_t value_ = 0;
+};
+
+namespace task_id {
+
+// Finaliser from splitmix64; spreads every input bit over the output.
+constexpr std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Hash of an id's text form. Generated ids are always kHexLength bytes,
+// which are hashed as two fixed 8-byte words rather than by the byte loop
+// of std::hash; any other length (e.g. "ROOT") falls back to std::hash.
+inline std::size_t hash_text(std::string_view id) {
+    if (id.size() != TaskId::kHexLength) {
+        return std::hash<std::string_view>{}(id);
+    }
+    std::uint64_t lo;
+    std::uint64_t hi;
+    std::memcpy(&lo, id.data(), sizeof(lo));
+    std::memcpy(&hi, id.data() + sizeof(lo), sizeof(hi));
+    return static_cast<std::size_t>(mix(lo ^ mix(hi)));
+}
+
+} // namespace task_id
+
+struct TaskIdHash {
+    std::size_t operator()(TaskId id) const {
+        return static_cast<std::size_t>(task_id::mix(id.value()));
+    }
+};
+
+#endif //TASKFARMER_V2_TASKID_HPP
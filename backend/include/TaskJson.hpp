@@ -0,0 +1,57 @@
+#ifndef TASKFARMER_V2_TASKJSON_HPP
+#define TASKFARMER_V2_TASKJSON_HPP
+
+#include "TaskNode.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Writes task JSON straight into a caller-owned buffer, without building a
+// nlohmann::json DOM first. Output matches what the DOM produced for the
+// same fields: strings are escaped the same way, enums are written as ints.
+namespace task_json {
+
+// Appends `value` as a quoted, escaped JSON string. Bytes that are not
+// part of well-formed UTF-8 are written as U+FFFD, so the output is always
+// valid JSON text.
+void append_string(std::string& out, std::string_view value);
+
+// Appends the fields /api/ls reports for a task ("id" .. "last_updated_at")
+// without the surrounding braces, so callers can add their own fields.
+void append_task_fields(std::string& out, const TaskNode& task);
+
+// Appends "rollup":{...} with the subtree aggregates of `task`: descendant
+// count, per-status and per-priority counts indexed by enum value, the
+// highest descendant priority (null for leaves) and completion percent.
+void append_rollup(std::string& out, const TaskNode& task);
+
+// Appends {<task fields>,<rollup>}.
+void append_task(std::string& out, const TaskNode& task);
+
+} // namespace task_json
+
+// Serialises a listing as a JSON array in bounded chunks, so a response can
+// be streamed to the socket with memory proportional to the chunk size
+// rather than to the listing.
+class TaskListingStream {
+public:
+    static constexpr std::size_t kDefaultChunkBytes = 16 * 1024;
+
+    explicit TaskListingStream(std::vector<TaskNode::Ptr> tasks,
+                               std::size_t chunk_bytes = kDefaultChunkBytes);
+
+    // Replaces `chunk` with the next piece of the array. Returns false once
+    // the closing bracket has already been produced.
+    bool next(std::string& chunk);
+
+private:
+    std::vector<TaskNode::Ptr> tasks_;
+    std::size_t chunk_bytes_;
+    std::size_t pos_ = 0;
+    bool opened_ = false;
+    bool closed_ = false;
+};
+
+#endif //TASKFARMER_V2_TASKJSON_HPP
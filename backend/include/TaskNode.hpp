@@ -1,16 +1,29 @@
 #ifndef TASKFARMER_V2_TASKNODE_HPP
 #define TASKFARMER_V2_TASKNODE_HPP
 
+#include <array>
 #include <ctime>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 enum class TaskStatus { TODO, IN_PROGRESS, COMPLETED, BLOCKED };
 
 enum class TaskPriority { LOW, MEDIUM, HIGH, CRITICAL };
 
+// Statuses and priorities arrive as plain integers, from request bodies and
+// database rows, and index the rollup arrays; check them with these first.
+constexpr bool is_valid_status(long long value) {
+    return value >= 0 && value <= static_cast<long long>(TaskStatus::BLOCKED);
+}
+
+constexpr bool is_valid_priority(long long value) {
+    return value >= 0 && value <= static_cast<long long>(TaskPriority::CRITICAL);
+}
+
 // TaskNode is a tree node representing a project/task.
 // We will use a "virtual workspace root" node titled "/" whose children are
 // top-level projects like "Tetris Clone" and "Sims Clone".
@@ -18,6 +31,23 @@ class TaskNode {
 public:
     using Ptr = std::shared_ptr<TaskNode>;
 
+    static constexpr std::size_t kTitleIndexThreshold = 32;
+
+    // Aggregates over every descendant (not the node itself). Updated along
+    // the ancestor chain by add_child, remove_child_by_id, set_status and
+    // set_priority, so reading them is O(1) and each update O(depth).
+    struct Rollup {
+        std::size_t descendants = 0;
+        std::array<std::size_t, 4> by_status{};
+        std::array<std::size_t, 4> by_priority{};
+
+        // Highest priority among the descendants, or nullopt if there are none.
+        std::optional<TaskPriority> max_priority() const;
+
+        // Share of COMPLETED descendants in percent; 0 when there are none.
+        double completion_percent() const;
+    };
+
 private:
     std::string id_;
     std::string title_;
@@ -30,7 +60,43 @@ private:
     std::time_t updated_at_ = 0;
 
     TaskNode* parent_ = nullptr;          // non-owning (down-only navigation)
-    std::vector<Ptr> children_;           // owning
+    std::vector<Ptr> children_;           // owning, ordered by (created_at, id)
+
+    Rollup rollup_;
+
+    // Adds (sign = +1) or subtracts (sign = -1) `child` and its rollup on
+    // this node and every ancestor above it.
+    void apply_to_ancestors(const TaskNode& child, int sign);
+
+    // Inserts `child` at its (created_at, id) position. New children are
+    // normally the newest, so this is usually an append.
+    void insert_ordered(const Ptr& child);
+
+    // Title -> child index for wide nodes, so find_child_by_title (and with
+    // it resolve_path) does not scan every sibling. Built once a node has
+    // kTitleIndexThreshold children and dropped again below half of that.
+    // Keys view the children's own title_ strings; set_title re-keys.
+    struct TitleHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view title) const {
+            return std::hash<std::string_view>{}(title);
+        }
+    };
+    using TitleIndex =
+        std::unordered_multimap<std::string_view, Ptr, TitleHash, std::equal_to<>>;
+
+    std::unique_ptr<TitleIndex> title_index_;
+
+    void build_title_index();
+
+    // Removes `child`'s entry and returns the owning pointer it held.
+    Ptr erase_title_entry(const TaskNode* child);
+
+    // find_child_by_title without the copy: the matching child's slot in
+    // children_ or title_index_, valid until the children change.
+    const Ptr* find_child_slot(std::string_view title) const;
+
+    friend Ptr resolve_path(const Ptr& workspace_root, std::string_view absolute_path);
 
 public:
     explicit TaskNode(std::string title, std::string description = "");
@@ -50,6 +116,10 @@ public:
         std::string description = ""
     );
 
+    // Copy of this node's own fields and rollup, with no parent and no
+    // children.
+    Ptr clone_detached() const;
+
     // Getters (return by const reference to avoid copies)
     const std::string& get_id() const { return id_; }
     const std::string& get_title() const { return title_; }
@@ -62,6 +132,16 @@ public:
 
     TaskNode* get_parent() const { return parent_; }
     const std::vector<Ptr>& get_children() const { return children_; }
+    const Rollup& get_rollup() const { return rollup_; }
+
+    // True if `a` sorts before (created_at, id). This is the order children_
+    // is kept in and the order listings are paginated in.
+    static bool ordered_before(const Ptr& a, std::time_t created_at, std::string_view id);
+
+    // Position of the first entry of an ordered listing that sorts after
+    // (created_at, id).
+    static std::vector<Ptr>::const_iterator first_after(
+        const std::vector<Ptr>& listing, std::time_t created_at, std::string_view id);
 
     // Mutators
     void set_title(const std::string& title);
@@ -72,12 +152,17 @@ public:
     // Tree operations
     void add_child(const Ptr& child);
 
+    // add_child for a tree being loaded from storage: leaves updated_at as
+    // stored instead of touching this node.
+    void link_child(const Ptr& child);
+
     // Returns true if a child was removed, false if not found.
     bool remove_child_by_id(const std::string& id);
 
     Ptr find_child_by_id(const std::string& id) const;
 
-    // Find direct child by title (name)
+    // Find direct child by title (name). With duplicate titles, the first
+    // child in children order wins. Hashed once the node is wide.
     Ptr find_child_by_title(std::string_view title) const;
 
     // Optional: helpful for debugging / displaying location
@@ -2,28 +2,138 @@
 #define TASKFARMER_V2_TASKSERVICE_HPP
 
 #include "Database.hpp"
+#include "ReadConnectionPool.hpp"
+#include "TaskId.hpp"
 #include "TaskNode.hpp"
+#include "WriteJournal.hpp"
 
+#include <array>
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <set>
 #include <shared_mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <stdexcept>
+
+struct TaskServiceConfig {
+    // Snapshot-publishing mode. Writers publish an immutable copy of every
+    // child listing they change, and ls_by_parent_id serves readers from the
+    // latest published version without touching mutex_, so reads never
+    // wait behind a writer's SQLite I/O.
+    bool snapshot_reads = false;
+
+    // Mutations are applied in memory under mutex_ and written to SQLite by
+    // a write-behind journal after the lock is released. `durability`
+    // chooses whether callers wait for that write to commit. If a write
+    // fails, the tree is rebuilt from the database: before the error
+    // reaches a WAL_COMMITTED caller, and otherwise by the next mutation or
+    // sync().
+    Durability durability = Durability::WAL_COMMITTED;
+
+    // Queue bound (backpressure) and group-commit batching of the journal.
+    WriteJournalConfig journal;
+
+    // Read-only connections that database reads (search) use instead of
+    // the writer's connection. Zero, or a database other connections
+    // cannot open (e.g. ":memory:"), keeps those reads on the writer.
+    std::size_t read_connections = 4;
+};
+
+// A task to be created by TaskService::create_batch, optionally with its
+// own subtree of new tasks.
+struct TaskDraft {
+    std::string title;
+    std::string description;
+    TaskStatus status = TaskStatus::TODO;
+    TaskPriority priority = TaskPriority::MEDIUM;
+    std::vector<TaskDraft> children;
+};
+
+// One node of a multi-level listing returned by TaskService::ls_subtree.
+// `children` is only filled for nodes inside the requested depth.
+struct TaskSubtree {
+    TaskNode::Ptr node;
+    bool has_children = false;
+    bool expanded = false;
+    std::vector<TaskSubtree> children;
+};
+
+struct SubtreeListing {
+    std::vector<TaskSubtree> children;   // direct children of the root
+    std::size_t node_count = 0;
+    bool truncated = false;              // the node limit cut the walk short
+};
+
+// Position in a child listing, for cursor pagination. Listings are ordered
+// by (created_at, id), so a cursor stays valid while siblings are added or
+// removed around it.
+struct ChildCursor {
+    std::time_t created_at = 0;
+    std::string id;
+
+    // Opaque, URL-safe form handed to clients.
+    std::string encode() const;
+
+    // Returns nullopt if `token` was not produced by encode().
+    static std::optional<ChildCursor> decode(std::string_view token);
+};
+
+struct ChildPage {
+    std::vector<TaskNode::Ptr> items;
+    std::optional<ChildCursor> next;     // unset on the last page
+};
+
+enum class TaskSortKey { CREATED_AT, UPDATED_AT, PRIORITY, STATUS, TITLE };
+
+// Server-side filter and sort over one parent's children. Empty status or
+// priority lists match any value; ties always fall back to (created_at, id).
+struct TaskQuery {
+    std::vector<TaskStatus> statuses;
+    std::vector<TaskPriority> priorities;
+    std::optional<std::time_t> updated_since;
+
+    TaskSortKey sort = TaskSortKey::CREATED_AT;
+    bool descending = false;
+    std::size_t limit = SIZE_MAX;
+};
+
+struct TaskQueryResult {
+    std::vector<TaskNode::Ptr> items;    // at most query.limit, sorted
+    std::size_t matched = 0;             // before the limit was applied
+};
+
+struct TaskSearchResult {
+    TaskNode::Ptr task;
+    std::string path;                    // titles from the workspace root
+    double score = 0;                    // bm25; lower is better
+};
+
 class TaskService {
 public:
-    explicit TaskService(Database& db);
+    explicit TaskService(Database& db, TaskServiceConfig config = {});
 
+    // Reloads the tree from the database, after the journal drains.
     void init();
 
-    // Returns the workspace root node.
+    // Returns the workspace root node (live; see create).
     TaskNode::Ptr workspace() const;
 
     // Lists children from an absolute path
-    // Returns a vector of shared pointers to the nodes in memory.
+    // Returns a vector of shared pointers to the nodes in memory (live).
     std::vector<TaskNode::Ptr> ls(std::string_view absolute_path) const;
 
     // Creates a new child tasks node under the parent path.
     // E.g. /A/AA with title AAA, then after successful creation, /A/AA/AAA
+    // Like every method that returns tasks to a caller outside mutex_
+    // (listings, queries, search, creates), it returns a detached copy;
+    // only workspace(), ls(), find() and find_by_id() hand out live nodes.
     TaskNode::Ptr create(
         std::string_view parent_path,
         std::string title,
@@ -37,10 +147,23 @@ public:
         TaskPriority priority
     );
 
+    // Creates every draft (and its nested children) under parent_id with a
+    // single lock acquisition and a single journal job, so the whole import
+    // commits in one transaction. Returns the created nodes in insertion
+    // order, every parent before its children.
+    std::vector<TaskNode::Ptr> create_batch(
+        std::string_view parent_id,
+        const std::vector<TaskDraft>& drafts
+    );
+
     // Returns the pointer to the task node at the absolute path.
     // Returns nullptr if it does not exist.
     TaskNode::Ptr find(std::string_view absolute_path) const;
-    TaskNode::Ptr find_by_id_in_memory(std::string_view id) const;
+
+    // O(1) lookup through the id index. Returns nullptr if there is no
+    // task with that id.
+    TaskNode::Ptr find_by_id(std::string_view id) const;
+
     bool modify(std::string_view id,
                          std::optional<std::string> title,
                          std::optional<std::string> description,
@@ -49,19 +172,167 @@ public:
 
     bool persist(const TaskNode::Ptr& node);
     bool delete_subtree(std::string_view id);
+    // Lists the children of parent_id as detached copies, which stay
+    // consistent however long the caller holds them. In snapshot mode they
+    // are the published copies; otherwise they are made under mutex_.
     std::vector<TaskNode::Ptr> ls_by_parent_id(std::string_view parent_id) const;
 
+    // Returns at most `limit` children of parent_id that sort after `after`
+    // (from the first child when unset), as detached copies like
+    // ls_by_parent_id. Only the page itself is copied.
+    ChildPage ls_page(std::string_view parent_id,
+                      const std::optional<ChildCursor>& after,
+                      std::size_t limit) const;
+
+    // Filters and sorts the children of parent_id. Status and priority
+    // filters are answered from per-parent indexes, so only matching rows
+    // are visited; updated_since is checked on those rows. The rows are
+    // detached copies, like ls_page's.
+    TaskQueryResult query_children(std::string_view parent_id,
+                                   const TaskQuery& query) const;
+
+    // Ranked full-text search over titles and descriptions (see
+    // Database::search_tasks). Hits are resolved against the in-memory tree
+    // for their current fields and path; tasks deleted since are skipped.
+    // Each result holds a detached copy of its task.
+    std::vector<TaskSearchResult> search(std::string_view text,
+                                         std::size_t limit,
+                                         std::size_t offset = 0) const;
+
+    // Lists up to `depth` levels below root_id in one call, breadth-first,
+    // stopping once `max_nodes` nodes have been collected. Returns nullopt
+    // if root_id does not exist (in snapshot mode an unknown root simply
+    // has no children). Nodes are detached copies, like ls_by_parent_id's.
+    std::optional<SubtreeListing> ls_subtree(std::string_view root_id,
+                                             std::size_t depth,
+                                             std::size_t max_nodes) const;
+
+    // Blocks until every queued write has reached the database.
+    void sync();
+
+    // Queue depth and backpressure counters of the write-behind journal.
+    WriteJournal::Stats journal_stats() const;
+
+    // Prepared-statement cache counters of the writer's connection.
+    StatementCache::Stats statement_cache_stats() const;
+
+    // Usage of the read connection pool; nullopt when there is none.
+    std::optional<ReadConnectionPool::Stats> read_pool_stats() const;
+
+    struct TreeStats {
+        std::size_t tasks = 0;
+        // Approximate bytes held by the in-memory tree, its indexes and,
+        // in snapshot mode, the published listings. Extrapolated from a
+        // sample of nodes.
+        std::size_t estimated_bytes = 0;
+    };
+
+    TreeStats tree_stats() const;
+
 private:
     Database& db_;
+    TaskServiceConfig config_;
 
     TaskNode::Ptr workspace_;
 
+    struct IdHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view id) const {
+            return task_id::hash_text(id);
+        }
+    };
+
+    // Every node in the workspace tree by id, kept in step with the tree by
+    // init, create and delete_subtree.
+    std::unordered_map<std::string, TaskNode::Ptr, IdHash, std::equal_to<>> index_;
+
+    // Secondary indexes over each parent's children by status and by
+    // priority, for query_children. Buckets keep the children order.
+    struct ChildOrder {
+        bool operator()(const TaskNode::Ptr& a, const TaskNode::Ptr& b) const {
+            return TaskNode::ordered_before(a, b->get_created_at(), b->get_id());
+        }
+    };
+    using FacetBucket = std::set<TaskNode::Ptr, ChildOrder>;
+
+    struct ChildFacets {
+        std::array<FacetBucket, 4> by_status;
+        std::array<FacetBucket, 4> by_priority;
+    };
+
+    std::unordered_map<std::string, ChildFacets, IdHash, std::equal_to<>> facets_;
+
     mutable std::shared_mutex mutex_;
 
     void require_initialised() const;
 
+    // find_by_id for callers that already hold mutex_.
+    TaskNode::Ptr find_by_id_in_memory(std::string_view id) const;
+
+    // Adds one node to index_ and to its parent's facets.
+    void index_node(const TaskNode::Ptr& node);
+    void index_subtree(const TaskNode::Ptr& root);
+    void unindex_subtree(const TaskNode::Ptr& root);
+
+    // Moves `node` in or out of the facets of its parent. Called around any
+    // status/priority change and before a node is detached.
+    void facet_insert(const TaskNode& parent, const TaskNode::Ptr& node);
+    void facet_erase(const TaskNode& parent, const TaskNode::Ptr& node);
+
+    // Published read-only view used in snapshot mode: parent id -> immutable
+    // listing of detached child copies. Listings are spread over shards so a
+    // writer copies one shard's map, not every listing, per publish.
+    using Listing = std::vector<TaskNode::Ptr>;
+    using ListingMap = std::unordered_map<
+        std::string, std::shared_ptr<const Listing>, IdHash, std::equal_to<>>;
+
+    static constexpr std::size_t kSnapshotShards = 64;
+
+    struct Snapshot {
+        std::array<std::shared_ptr<const ListingMap>, kSnapshotShards> shards;
+    };
+
+    std::atomic<std::shared_ptr<const Snapshot>> snapshot_;
+
+    static std::size_t snapshot_shard(std::string_view parent_id);
+
+    // Rebuilds every listing from the live tree (init only).
+    void publish_all();
+
+    // Republishes the listing of `parent`. Unchanged children reuse their
+    // previously published copies; `changed` always gets a fresh one.
+    void publish_children(const TaskNode& parent, const TaskNode* changed = nullptr);
+
+    // Republishes `node` and each of its ancestors in their parents'
+    // listings, whose copies carry rollups that a change below made stale.
+    void publish_ancestors(const TaskNode& node);
+
+    // Drops the listings of every node in the subtree rooted at `root`.
+    void unpublish_subtree(const TaskNode::Ptr& root);
+
     TaskNode::Ptr resolve(std::string_view absolute_path) const;
 
+    // Waits for a queued write when the durability level requires it. If
+    // the write failed, the tree is resynced before the error is rethrown.
+    void await_write(std::future<void>& written);
+
+    // (Re)builds the tree, indexes and snapshot from the database once the
+    // journal has drained. Callers other than the constructor hold mutex_
+    // exclusively.
+    void load_workspace();
+
+    // Rebuilds the tree from the database if any journal job failed since
+    // the last load, so memory never keeps a change SQLite rejected.
+    // Called with mutex_ held exclusively, before each mutation.
+    void resync_after_failed_writes();
+
+    // journal_->failed_jobs() as of the last load_workspace.
+    std::uint64_t failed_writes_seen_ = 0;
+
+    std::unique_ptr<ReadConnectionPool> readers_;
+
+    // Declared last so it drains before anything else is torn down.
+    std::unique_ptr<WriteJournal> journal_;
 };
 
 
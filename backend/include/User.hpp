@@ -1,11 +1,11 @@
 #ifndef TASKFARMER_V2_USER_HPP
 #define TASKFARMER_V2_USER_HPP
 
-#include <random>
-#include <iostream>
-#include <sstream>
+#include <string>
+#include <vector>
 
 #include "Rbac.hpp"
+#include "TaskId.hpp"
 
 struct User {
     std::string id;
@@ -13,15 +13,9 @@ struct User {
     std::vector<Role> roles;
 };
 
+// User ids share the task id format: 16 hex digits from TaskId::generate.
 inline std::string generate_uuid() {
-    static thread_local std::mt19937 rng{std::random_device{}()};
-    static thread_local std::uniform_int_distribution<int> dist(0, 15);
-
-    std::ostringstream oss;
-    for (int i = 0; i < 16; ++i) {
-        oss << std::hex << dist(rng);
-    }
-    return oss.str();
+    return TaskId::generate().to_hex();
 }
 
 #endif
\ No newline at end of file
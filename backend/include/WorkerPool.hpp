@@ -0,0 +1,79 @@
+#ifndef TASKFARMER_V2_WORKERPOOL_HPP
+#define TASKFARMER_V2_WORKERPOOL_HPP
+
+#include "Metrics.hpp"
+
+#include <httplib.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// httplib task queue with a bounded backlog. Each job is one accepted
+// connection.
+//
+// Up to `max_queued` connections wait for a worker as usual. Past that,
+// connections are still accepted but marked for shedding: they jump the
+// queue, and the worker that picks one up sees take_shed_flag() return
+// true, so HttpServer answers its first request with 503 instead of
+// routing it. Answering is cheap, so an overloaded server tells clients to
+// back off within milliseconds rather than leaving them to time out. Once
+// another `max_queued` connections are waiting to be shed, enqueue fails
+// and httplib closes new connections outright.
+//
+// max_queued == 0 disables the bound, as httplib's own ThreadPool does.
+//
+// `on_connection_end` runs on the worker after each connection, however
+// the connection ended, to drop per-request state that httplib's logger
+// would otherwise be the only one to clear.
+class WorkerPool final : public httplib::TaskQueue {
+public:
+    WorkerPool(std::size_t threads, std::size_t max_queued,
+               std::function<void()> on_connection_end = {});
+    ~WorkerPool() override;
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    bool enqueue(std::function<void()> fn) override;
+
+    // Runs every queued job, then joins the workers.
+    void shutdown() override;
+
+    // True, once, on a worker running a connection queued past max_queued.
+    static bool take_shed_flag();
+
+    // How long the connection the calling worker is running waited in the
+    // queue; returned once, for its first request, and zero afterwards.
+    static std::chrono::steady_clock::duration take_queue_wait();
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    const std::size_t max_queued_;
+    const std::function<void()> on_connection_end_;
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<Job> jobs_;
+    std::deque<Job> shed_;
+    bool shutdown_ = false;
+    std::vector<std::thread> workers_;
+
+    metrics::Gauge& depth_;
+    metrics::Counter& shed_total_;
+    metrics::Counter& rejected_total_;
+    metrics::Histogram& queue_wait_;
+
+    void run();
+};
+
+#endif //TASKFARMER_V2_WORKERPOOL_HPP
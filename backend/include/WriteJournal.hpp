@@ -0,0 +1,128 @@
+#ifndef TASKFARMER_V2_WRITEJOURNAL_HPP
+#define TASKFARMER_V2_WRITEJOURNAL_HPP
+
+#include "Database.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// When a write is acknowledged to the caller.
+enum class Durability {
+    IN_MEMORY,      // as soon as it is applied in memory and queued
+    WAL_COMMITTED   // once the writer thread has committed it to SQLite
+};
+
+struct WriteJournalConfig {
+    // Maximum number of queued writes before submit() blocks.
+    std::size_t capacity = 1024;
+
+    // Group commit: the writer thread runs up to `max_batch` queued jobs in
+    // one transaction. After taking the first job it keeps collecting for
+    // up to `batch_window`; with a zero window it only takes what is
+    // already queued, so batches grow with load and an idle server adds
+    // no latency.
+    std::size_t max_batch = 128;
+    std::chrono::microseconds batch_window{0};
+};
+
+// Write-behind queue in front of Database.
+// Mutations are applied to the in-memory tree by the caller and queued here
+// as jobs; a dedicated writer thread runs them against the database in
+// submission order. The queue is bounded: submit() blocks while it is full,
+// which pushes back on the request threads instead of growing without limit.
+//
+// Jobs are group-committed: each batch is one BEGIN ... COMMIT, with every
+// job inside its own savepoint so a failing job is rolled back alone. All
+// callers in a batch are completed together once the COMMIT returns. Jobs
+// therefore always run inside a transaction and must not open their own.
+//
+// A failed job is not retried and the rest of its batch still commits, so
+// the database then lacks a change its submitter has already applied in
+// memory. failed_jobs() counts such jobs; it is raised before their futures
+// are settled, letting the owner of the in-memory state notice the failure
+// and resync from the database (see TaskService).
+class WriteJournal {
+public:
+    using Job = std::function<void(Database&)>;
+
+    struct Stats {
+        std::uint64_t submitted = 0;
+        std::uint64_t completed = 0;
+        std::uint64_t failed = 0;
+        // Backpressure: submits that found the queue full, and the total
+        // time they spent waiting for room.
+        std::uint64_t blocked_submits = 0;
+        std::uint64_t blocked_ns = 0;
+        std::size_t depth = 0;
+        std::size_t max_depth = 0;
+        std::size_t capacity = 0;
+        // Group commit: transactions committed and the largest batch seen.
+        std::uint64_t batches = 0;
+        std::size_t max_batch = 0;
+    };
+
+    WriteJournal(Database& db, WriteJournalConfig config);
+
+    // Drains every queued job, then stops the writer thread.
+    ~WriteJournal();
+
+    WriteJournal(const WriteJournal&) = delete;
+    WriteJournal& operator=(const WriteJournal&) = delete;
+
+    // Queues a job. The future becomes ready once the job has been committed
+    // and carries any exception it threw.
+    std::future<void> submit(Job job);
+
+    // Blocks until every job submitted so far has been run.
+    void flush();
+
+    // Runs `fn` on the journal's connection from the calling thread,
+    // between batches: it never overlaps the writer thread or sees a batch's
+    // open transaction. For reads that have no other connection to use.
+    void with_connection(const Job& fn);
+
+    Stats stats() const;
+
+    // Jobs that failed so far, whether alone or with their whole batch.
+    std::uint64_t failed_jobs() const { return failed_jobs_.load(std::memory_order_acquire); }
+
+private:
+    struct Pending {
+        Job job;
+        std::promise<void> done;
+    };
+
+    Database& db_;
+    const WriteJournalConfig config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::condition_variable drained_;
+    std::deque<Pending> queue_;
+    bool busy_ = false;
+    bool stopping_ = false;
+
+    Stats stats_;
+    std::atomic<std::uint64_t> failed_jobs_{0};
+
+    // Held by the writer thread for each batch and by with_connection.
+    std::mutex connection_mutex_;
+
+    std::thread worker_;
+
+    void run();
+
+    // Runs one batch in a single transaction and settles its promises.
+    void commit_batch(std::vector<Pending>& batch);
+};
+
+#endif
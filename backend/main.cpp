@@ -2,19 +2,170 @@
 #include "include/HttpServer.hpp"
 #include "include/TaskService.hpp"
 
+#include <charconv>
 #include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+void print_usage(std::ostream& out, const char* program) {
+    const HttpServerConfig defaults;
+    const TaskServiceConfig service_defaults;
+    out
+        << "Usage: " << program << " [options]\n"
+        << "  --db PATH                  SQLite database file (taskfarmer.db)\n"
+        << "  --host HOST                address to listen on (" << defaults.host << ")\n"
+        << "  --port N                   port to listen on (" << defaults.port << ")\n"
+        << "  --threads N                HTTP worker threads (" << defaults.worker_threads << ")\n"
+        << "  --queue-depth N            connections queued before shedding with 503, 0 = unbounded ("
+        << defaults.max_queued << ")\n"
+        << "  --keep-alive-max N         requests per kept-alive connection ("
+        << defaults.keep_alive_max_count << ")\n"
+        << "  --keep-alive-timeout SECS  idle timeout of kept-alive connections ("
+        << defaults.keep_alive_timeout.count() << ")\n"
+        << "  --read-timeout SECS        socket read timeout (" << defaults.read_timeout.count() << ")\n"
+        << "  --write-timeout SECS       socket write timeout (" << defaults.write_timeout.count() << ")\n"
+        << "  --max-body BYTES           largest accepted request body ("
+        << defaults.payload_max_bytes << ")\n"
+        << "  --access-log-sample RATE   fraction of requests logged, 0..1 ("
+        << defaults.access_log.sample_rate << ")\n"
+        << "  --admission on|off         admission control in front of the API routes (on)\n"
+        << "  --read-budget-ms MS        queue time after which reads get 503 ("
+        << defaults.admission.read_budget.count() << ")\n"
+        << "  --write-budget-ms MS       queue time after which writes get 503 ("
+        << defaults.admission.write_budget.count() << ")\n"
+        << "  --bulk-concurrency N       batch creates and deletes run at once ("
+        << defaults.admission.bulk_concurrency << ")\n"
+        << "  --write-waiting N          writes that may wait for a slot, 0 = half the write workers ("
+        << defaults.admission.write_waiting << ")\n"
+        << "  --compression on|off       gzip/br/zstd for JSON and text responses (on)\n"
+        << "  --compress-min-bytes N     smallest response body compressed ("
+        << defaults.compression.min_bytes << ")\n"
+        << "  --gzip-level N             1..9 (" << defaults.compression.gzip_level << ")\n"
+        << "  --brotli-quality N         0..11 (" << defaults.compression.brotli_quality << ")\n"
+        << "  --zstd-level N             1..19 (" << defaults.compression.zstd_level << ")\n"
+        << "  --snapshot-reads on|off    serve child listings from published snapshots ("
+        << (service_defaults.snapshot_reads ? "on" : "off") << ")\n"
+        << "  --durability memory|wal    acknowledge writes once queued or once committed ("
+        << (service_defaults.durability == Durability::IN_MEMORY ? "memory" : "wal") << ")\n"
+        << "  --journal-capacity N       queued writes before writers block ("
+        << service_defaults.journal.capacity << ")\n"
+        << "  --journal-batch N          most writes committed in one transaction ("
+        << service_defaults.journal.max_batch << ")\n"
+        << "  --journal-window-us US     time spent collecting a batch ("
+        << service_defaults.journal.batch_window.count() << ")\n";
+}
+
+template <typename Number>
+Number parse_number(std::string_view flag, std::string_view text) {
+    Number value{};
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || end != text.data() + text.size()) {
+        throw std::runtime_error("[ERROR] invalid value for " + std::string(flag) + ": " +
+                                 std::string(text));
+    }
+    return value;
+}
+
+bool parse_on_off(std::string_view flag, std::string_view text) {
+    if (text != "on" && text != "off") {
+        throw std::runtime_error("[ERROR] " + std::string(flag) + " must be on or off");
+    }
+    return text == "on";
+}
+
+// Returns false if --help was given.
+bool parse_args(int argc, char** argv, std::string& db_path, HttpServerConfig& config,
+                TaskServiceConfig& service_config) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view flag = argv[i];
+        if (flag == "--help" || flag == "-h") {
+            return false;
+        }
+        if (i + 1 >= argc) {
+            throw std::runtime_error("[ERROR] missing value for " + std::string(flag));
+        }
+        const std::string_view value = argv[++i];
+
+        if (flag == "--db") db_path = value;
+        else if (flag == "--host") config.host = value;
+        else if (flag == "--port") config.port = parse_number<int>(flag, value);
+        else if (flag == "--threads") config.worker_threads = parse_number<std::size_t>(flag, value);
+        else if (flag == "--queue-depth") config.max_queued = parse_number<std::size_t>(flag, value);
+        else if (flag == "--keep-alive-max")
+            config.keep_alive_max_count = parse_number<std::size_t>(flag, value);
+        else if (flag == "--keep-alive-timeout")
+            config.keep_alive_timeout = std::chrono::seconds(parse_number<long>(flag, value));
+        else if (flag == "--read-timeout")
+            config.read_timeout = std::chrono::seconds(parse_number<long>(flag, value));
+        else if (flag == "--write-timeout")
+            config.write_timeout = std::chrono::seconds(parse_number<long>(flag, value));
+        else if (flag == "--max-body") config.payload_max_bytes = parse_number<std::size_t>(flag, value);
+        else if (flag == "--access-log-sample")
+            config.access_log.sample_rate = parse_number<double>(flag, value);
+        else if (flag == "--admission") config.admission.enabled = parse_on_off(flag, value);
+        else if (flag == "--read-budget-ms")
+            config.admission.read_budget = std::chrono::milliseconds(parse_number<long>(flag, value));
+        else if (flag == "--write-budget-ms")
+            config.admission.write_budget = std::chrono::milliseconds(parse_number<long>(flag, value));
+        else if (flag == "--bulk-concurrency")
+            config.admission.bulk_concurrency = parse_number<std::size_t>(flag, value);
+        else if (flag == "--write-waiting")
+            config.admission.write_waiting = parse_number<std::size_t>(flag, value);
+        else if (flag == "--compression") config.compression.enabled = parse_on_off(flag, value);
+        else if (flag == "--compress-min-bytes")
+            config.compression.min_bytes = parse_number<std::size_t>(flag, value);
+        else if (flag == "--gzip-level") config.compression.gzip_level = parse_number<int>(flag, value);
+        else if (flag == "--brotli-quality")
+            config.compression.brotli_quality = parse_number<int>(flag, value);
+        else if (flag == "--zstd-level") config.compression.zstd_level = parse_number<int>(flag, value);
+        else if (flag == "--snapshot-reads")
+            service_config.snapshot_reads = parse_on_off(flag, value);
+        else if (flag == "--durability") {
+            if (value != "memory" && value != "wal") {
+                throw std::runtime_error("[ERROR] --durability must be memory or wal");
+            }
+            service_config.durability =
+                value == "memory" ? Durability::IN_MEMORY : Durability::WAL_COMMITTED;
+        }
+        else if (flag == "--journal-capacity")
+            service_config.journal.capacity = parse_number<std::size_t>(flag, value);
+        else if (flag == "--journal-batch")
+            service_config.journal.max_batch = parse_number<std::size_t>(flag, value);
+        else if (flag == "--journal-window-us")
+            service_config.journal.batch_window =
+                std::chrono::microseconds(parse_number<long>(flag, value));
+        else throw std::runtime_error("[ERROR] unknown option " + std::string(flag));
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+      std::string db_path = "taskfarmer.db";
+      HttpServerConfig config;
+      TaskServiceConfig service_config;
 
-int main() {
       try {
-            Database db("taskfarmer.db");
-            TaskService service(db);
-            service.init();
+            if (!parse_args(argc, argv, db_path, config, service_config)) {
+                  print_usage(std::cout, argv[0]);
+                  return 0;
+            }
+      } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            print_usage(std::cerr, argv[0]);
+            return 2;
+      }
 
-            const std::string host = "0.0.0.0";
-            const int port = 8080;
+      try {
+            Database db(db_path);
+            TaskService service(db, service_config);
 
-            std::cout << "Starting HttpServer on " << host << ":" << port << "\n";
-            HttpServer server(host, port, service);
+            std::cout << "Starting HttpServer on " << config.host << ":" << config.port
+                      << " with " << config.worker_threads << " workers\n";
+            HttpServer server(config, service);
             server.run();
       } catch (const std::exception& e) {
             std::cerr << "Fatal: " << e.what() << "\n";
@@ -22,4 +173,4 @@ int main() {
       }
 
       return 0;
-}
\ No newline at end of file
+}
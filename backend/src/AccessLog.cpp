@@ -0,0 +1,208 @@
+#include "../include/AccessLog.hpp"
+#include "../include/TaskJson.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::atomic<std::uint64_t> next_log_id{1};
+
+// splitmix64 over a per-thread state; only decides sampling.
+std::uint64_t next_random() {
+    static thread_local std::uint64_t state =
+        std::chrono::steady_clock::now().time_since_epoch().count() ^
+        std::hash<std::thread::id>{}(std::this_thread::get_id());
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+template <std::size_t N>
+std::uint8_t copy_truncated(char (&dest)[N], std::string_view value) {
+    static_assert(N <= std::numeric_limits<std::uint8_t>::max());
+    const std::size_t n = std::min(value.size(), N);
+    std::memcpy(dest, value.data(), n);
+    return static_cast<std::uint8_t>(n);
+}
+
+template <typename Int>
+void append_int(std::string& out, Int value) {
+    char buf[24];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+} // namespace
+
+AccessLog::AccessLog(AccessLogConfig config)
+    : config_(config),
+      id_(next_log_id.fetch_add(1, std::memory_order_relaxed)),
+      written_(metrics::registry().counter(
+          "taskfarmer_access_log_written_total", "Access log lines written.")),
+      dropped_(metrics::registry().counter(
+          "taskfarmer_access_log_dropped_total",
+          "Access log entries dropped because a thread's buffer was full.")),
+      sampled_out_(metrics::registry().counter(
+          "taskfarmer_access_log_sampled_out_total",
+          "Requests not logged because of sampling.")) {
+    if (config_.out == nullptr) {
+        throw std::runtime_error("[ERROR] AccessLog: out must not be null.");
+    }
+    if (!(config_.sample_rate >= 0.0 && config_.sample_rate <= 1.0)) {
+        throw std::runtime_error("[ERROR] AccessLog: sample_rate must be within [0, 1].");
+    }
+    if (config_.buffer_entries == 0) {
+        throw std::runtime_error("[ERROR] AccessLog: buffer_entries must be positive.");
+    }
+
+    ring_capacity_ = std::bit_ceil(config_.buffer_entries);
+    sample_threshold_ = config_.sample_rate >= 1.0
+        ? std::numeric_limits<std::uint64_t>::max()
+        : static_cast<std::uint64_t>(config_.sample_rate * 18446744073709551616.0);
+
+    writer_ = std::thread([this] { run(); });
+}
+
+AccessLog::~AccessLog() {
+    {
+        std::lock_guard lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    writer_.join();
+}
+
+AccessLog::Ring& AccessLog::local_ring() {
+    // A thread normally records into one log, but look the ring up by log
+    // id so a second log (or a later one at the same address) gets its own.
+    static thread_local std::vector<std::pair<std::uint64_t, Ring*>> rings;
+    for (const auto& [id, ring] : rings) {
+        if (id == id_) {
+            return *ring;
+        }
+    }
+
+    auto ring = std::make_unique<Ring>(ring_capacity_);
+    Ring* raw = ring.get();
+    {
+        std::lock_guard lock(rings_mutex_);
+        rings_.push_back(std::move(ring));
+    }
+    rings.emplace_back(id_, raw);
+    return *raw;
+}
+
+void AccessLog::record(std::string_view method,
+                       std::string_view path,
+                       int status,
+                       std::chrono::steady_clock::duration duration,
+                       std::size_t bytes,
+                       std::string_view remote) {
+    if (status < 500 && sample_threshold_ != std::numeric_limits<std::uint64_t>::max() &&
+        next_random() >= sample_threshold_) {
+        sampled_out_.add();
+        return;
+    }
+
+    Ring& ring = local_ring();
+    const std::size_t tail = ring.tail.load(std::memory_order_relaxed);
+    const std::size_t used = tail - ring.head.load(std::memory_order_acquire);
+    if (used >= ring_capacity_) {
+        dropped_.add();
+        return;
+    }
+
+    Entry& entry = ring.entries[tail & ring.mask];
+    entry.ts_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    entry.duration_us = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    entry.bytes = bytes;
+    entry.status = status;
+    entry.method_len = copy_truncated(entry.method, method);
+    entry.path_len = copy_truncated(entry.path, path);
+    entry.remote_len = copy_truncated(entry.remote, remote);
+
+    ring.tail.store(tail + 1, std::memory_order_release);
+
+    // Bursts can fill a ring well within flush_interval; wake the writer
+    // early, once per fill, rather than start dropping.
+    if (used + 1 == ring_capacity_ / 2) {
+        wake_.notify_one();
+    }
+}
+
+AccessLog::Stats AccessLog::stats() const {
+    return Stats{written_.value(), dropped_.value(), sampled_out_.value()};
+}
+
+void AccessLog::run() {
+    std::string buffer;
+    buffer.reserve(64 * 1024);
+
+    std::unique_lock lock(wake_mutex_);
+    while (!stop_) {
+        wake_.wait_for(lock, config_.flush_interval);
+        lock.unlock();
+        drain(buffer);
+        lock.lock();
+    }
+    lock.unlock();
+
+    // Entries recorded before the destructor was called, if stop_ was
+    // already set when the loop last checked it.
+    drain(buffer);
+}
+
+void AccessLog::drain(std::string& buffer) {
+    buffer.clear();
+    std::uint64_t lines = 0;
+
+    {
+        std::lock_guard lock(rings_mutex_);
+        for (const auto& ring : rings_) {
+            const std::size_t head = ring->head.load(std::memory_order_relaxed);
+            const std::size_t tail = ring->tail.load(std::memory_order_acquire);
+
+            for (std::size_t i = head; i != tail; ++i) {
+                const Entry& entry = ring->entries[i & ring->mask];
+
+                buffer += "{\"ts_ms\":";
+                append_int(buffer, entry.ts_ms);
+                buffer += ",\"method\":";
+                task_json::append_string(buffer, {entry.method, entry.method_len});
+                buffer += ",\"path\":";
+                task_json::append_string(buffer, {entry.path, entry.path_len});
+                buffer += ",\"status\":";
+                append_int(buffer, entry.status);
+                buffer += ",\"duration_us\":";
+                append_int(buffer, entry.duration_us);
+                buffer += ",\"bytes\":";
+                append_int(buffer, entry.bytes);
+                buffer += ",\"remote\":";
+                task_json::append_string(buffer, {entry.remote, entry.remote_len});
+                buffer += "}\n";
+            }
+
+            // Slots are handed back once copied into buffer, before the
+            // (possibly slow) write below.
+            ring->head.store(tail, std::memory_order_release);
+            lines += tail - head;
+        }
+    }
+
+    if (buffer.empty()) {
+        return;
+    }
+    std::fwrite(buffer.data(), 1, buffer.size(), config_.out);
+    std::fflush(config_.out);
+    written_.add(lines);
+}
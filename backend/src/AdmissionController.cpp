@@ -0,0 +1,167 @@
+#include "../include/AdmissionController.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+AdmissionController::Ticket::Ticket(Ticket&& other) noexcept
+    : owner_(std::exchange(other.owner_, nullptr)), route_(std::exchange(other.route_, nullptr)) {}
+
+AdmissionController::Ticket& AdmissionController::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        reset();
+        owner_ = std::exchange(other.owner_, nullptr);
+        route_ = std::exchange(other.route_, nullptr);
+    }
+    return *this;
+}
+
+void AdmissionController::Ticket::reset() {
+    if (owner_) {
+        owner_->release(*route_);
+        owner_ = nullptr;
+        route_ = nullptr;
+    }
+}
+
+AdmissionController::AdmissionController(AdmissionConfig config, std::size_t workers)
+    : config_(config), workers_(workers) {
+    if (workers_ == 0) {
+        throw std::runtime_error("[ERROR] AdmissionController: workers must be positive.");
+    }
+    if (config_.bulk_concurrency == 0) {
+        throw std::runtime_error("[ERROR] AdmissionController: bulk_concurrency must be positive.");
+    }
+
+    const std::size_t reserve = config_.read_reserve != 0
+        ? config_.read_reserve
+        : std::max<std::size_t>(1, workers_ / 4);
+    // A single worker is shared rather than left to reads alone.
+    const std::size_t write_capacity = reserve < workers_ ? workers_ - reserve : 1;
+
+    // At least one worker always runs writes.
+    write_waiting_ = std::min(
+        config_.write_waiting != 0 ? config_.write_waiting : write_capacity / 2,
+        write_capacity - 1);
+    write_running_ = write_capacity - write_waiting_;
+}
+
+void AdmissionController::add_route(std::string key, RouteClass route_class) {
+    const std::size_t space = key.find(' ');
+    const std::string_view method = std::string_view(key).substr(0, space);
+    const std::string_view path =
+        space == std::string::npos ? std::string_view{} : std::string_view(key).substr(space + 1);
+
+    Route route;
+    route.route_class = route_class;
+    switch (route_class) {
+        case RouteClass::EXEMPT:
+            break;
+        case RouteClass::READ:
+            route.limit = workers_;
+            route.budget = config_.read_budget;
+            break;
+        case RouteClass::WRITE:
+            route.limit = write_running_;
+            route.budget = config_.write_budget;
+            break;
+        case RouteClass::BULK:
+            route.limit = std::min(config_.bulk_concurrency, write_running_);
+            route.budget = config_.write_budget;
+            break;
+    }
+
+    if (route_class != RouteClass::EXEMPT) {
+        const std::string route_labels = metrics::labels({{"method", method}, {"route", path}});
+        auto& registry = metrics::registry();
+        route.wait = &registry.histogram(
+            "taskfarmer_admission_wait_seconds",
+            "Time admitted requests waited for a slot.", route_labels);
+        route.queue_full = &registry.counter(
+            "taskfarmer_admission_rejected_total",
+            "Requests rejected by admission control, by reason.",
+            metrics::labels({{"method", method}, {"route", path}, {"reason", "queue_full"}}));
+        route.timed_out = &registry.counter(
+            "taskfarmer_admission_rejected_total",
+            "Requests rejected by admission control, by reason.",
+            metrics::labels({{"method", method}, {"route", path}, {"reason", "timeout"}}));
+        route.in_flight_gauge = &registry.gauge(
+            "taskfarmer_admission_in_flight",
+            "Admitted requests still running.", route_labels);
+    }
+
+    routes_.insert_or_assign(std::move(key), route);
+}
+
+bool AdmissionController::can_start(const Route& route) const {
+    if (route.in_flight >= route.limit) {
+        return false;
+    }
+    if (route.route_class == RouteClass::READ) {
+        return true;
+    }
+    return writes_in_flight_ < write_running_;
+}
+
+AdmissionController::Outcome AdmissionController::admit(
+    std::string_view key, std::chrono::steady_clock::duration queued, Ticket& ticket) {
+    const auto it = routes_.find(key);
+    if (it == routes_.end() || it->second.route_class == RouteClass::EXEMPT) {
+        return Outcome::ADMITTED;
+    }
+    Route& route = it->second;
+    const bool write = route.route_class != RouteClass::READ;
+
+    // Already late: answering now is cheaper than running it for a client
+    // that has likely given up, and helps the backlog drain.
+    if (queued >= route.budget) {
+        route.timed_out->add();
+        return Outcome::TIMED_OUT;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::unique_lock lock(mutex_);
+        if (!can_start(route)) {
+            // A waiting request holds its worker too, so waiting writes
+            // are bounded to keep them off the workers left to reads.
+            if (route.waiting >= config_.max_waiting ||
+                (write && writes_waiting_ >= write_waiting_)) {
+                lock.unlock();
+                route.queue_full->add();
+                return Outcome::QUEUE_FULL;
+            }
+
+            ++route.waiting;
+            writes_waiting_ += write ? 1 : 0;
+            const bool ready = released_.wait_until(
+                lock, start + (route.budget - queued), [&] { return can_start(route); });
+            --route.waiting;
+            writes_waiting_ -= write ? 1 : 0;
+
+            if (!ready) {
+                lock.unlock();
+                route.timed_out->add();
+                return Outcome::TIMED_OUT;
+            }
+        }
+
+        ++route.in_flight;
+        writes_in_flight_ += write ? 1 : 0;
+        route.in_flight_gauge->set(static_cast<std::int64_t>(route.in_flight));
+    }
+
+    route.wait->observe(std::chrono::steady_clock::now() - start);
+    ticket = Ticket(this, &route);
+    return Outcome::ADMITTED;
+}
+
+void AdmissionController::release(Route& route) {
+    {
+        std::lock_guard lock(mutex_);
+        --route.in_flight;
+        writes_in_flight_ -= route.route_class != RouteClass::READ ? 1 : 0;
+        route.in_flight_gauge->set(static_cast<std::int64_t>(route.in_flight));
+    }
+    released_.notify_all();
+}
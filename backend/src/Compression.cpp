@@ -0,0 +1,366 @@
+#include "../include/Compression.hpp"
+#include "../include/Metrics.hpp"
+
+#include <zlib.h>
+#ifdef TASKFARMER_WITH_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef TASKFARMER_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include <time.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace compression {
+
+class Compressor::Encoder {
+public:
+    virtual ~Encoder() = default;
+    virtual void update(std::string_view input, std::string& out) = 0;
+    virtual void finish(std::string& out) = 0;
+};
+
+namespace {
+
+constexpr std::size_t kOutputStep = 16 * 1024;
+
+// Grows `out` by kOutputStep and returns where the new space starts.
+char* grow(std::string& out, std::size_t& used) {
+    used = out.size();
+    out.resize(used + kOutputStep);
+    return out.data() + used;
+}
+
+class GzipEncoder final : public Compressor::Encoder {
+public:
+    explicit GzipEncoder(int level) {
+        // 15 + 16: largest window, with a gzip header and trailer.
+        if (deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("[ERROR] GzipEncoder: deflateInit2 failed.");
+        }
+    }
+
+    ~GzipEncoder() override { deflateEnd(&stream_); }
+
+    void update(std::string_view input, std::string& out) override { run(input, Z_NO_FLUSH, out); }
+    void finish(std::string& out) override { run({}, Z_FINISH, out); }
+
+private:
+    z_stream stream_{};
+
+    void run(std::string_view input, int flush, std::string& out) {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+
+        while (true) {
+            std::size_t used = 0;
+            stream_.next_out = reinterpret_cast<Bytef*>(grow(out, used));
+            stream_.avail_out = static_cast<uInt>(kOutputStep);
+
+            const int rc = deflate(&stream_, flush);
+            out.resize(used + kOutputStep - stream_.avail_out);
+            if (rc == Z_STREAM_ERROR) {
+                throw std::runtime_error("[ERROR] GzipEncoder: deflate failed.");
+            }
+            if (flush == Z_FINISH ? rc == Z_STREAM_END : stream_.avail_out != 0) {
+                return;
+            }
+        }
+    }
+};
+
+#ifdef TASKFARMER_WITH_BROTLI
+class BrotliEncoder final : public Compressor::Encoder {
+public:
+    explicit BrotliEncoder(int quality)
+        : state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr)) {
+        if (state_ == nullptr) {
+            throw std::runtime_error("[ERROR] BrotliEncoder: cannot create encoder.");
+        }
+        BrotliEncoderSetParameter(state_, BROTLI_PARAM_QUALITY, static_cast<std::uint32_t>(quality));
+        BrotliEncoderSetParameter(state_, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+    }
+
+    ~BrotliEncoder() override { BrotliEncoderDestroyInstance(state_); }
+
+    void update(std::string_view input, std::string& out) override {
+        run(input, BROTLI_OPERATION_PROCESS, out);
+    }
+    void finish(std::string& out) override { run({}, BROTLI_OPERATION_FINISH, out); }
+
+private:
+    BrotliEncoderState* state_;
+
+    void run(std::string_view input, BrotliEncoderOperation op, std::string& out) {
+        std::size_t available_in = input.size();
+        auto next_in = reinterpret_cast<const std::uint8_t*>(input.data());
+
+        while (true) {
+            std::size_t used = 0;
+            auto next_out = reinterpret_cast<std::uint8_t*>(grow(out, used));
+            std::size_t available_out = kOutputStep;
+
+            if (!BrotliEncoderCompressStream(state_, op, &available_in, &next_in,
+                                             &available_out, &next_out, nullptr)) {
+                throw std::runtime_error("[ERROR] BrotliEncoder: compression failed.");
+            }
+            out.resize(used + kOutputStep - available_out);
+
+            const bool drained = available_in == 0 && !BrotliEncoderHasMoreOutput(state_);
+            if (op == BROTLI_OPERATION_FINISH ? BrotliEncoderIsFinished(state_) : drained) {
+                return;
+            }
+        }
+    }
+};
+#endif
+
+#ifdef TASKFARMER_WITH_ZSTD
+class ZstdEncoder final : public Compressor::Encoder {
+public:
+    explicit ZstdEncoder(int level) : context_(ZSTD_createCCtx()) {
+        if (context_ == nullptr) {
+            throw std::runtime_error("[ERROR] ZstdEncoder: cannot create context.");
+        }
+        ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel, level);
+    }
+
+    ~ZstdEncoder() override { ZSTD_freeCCtx(context_); }
+
+    void update(std::string_view input, std::string& out) override {
+        run(input, ZSTD_e_continue, out);
+    }
+    void finish(std::string& out) override { run({}, ZSTD_e_end, out); }
+
+private:
+    ZSTD_CCtx* context_;
+
+    void run(std::string_view input, ZSTD_EndDirective mode, std::string& out) {
+        ZSTD_inBuffer in{input.data(), input.size(), 0};
+
+        while (true) {
+            std::size_t used = 0;
+            ZSTD_outBuffer buffer{grow(out, used), kOutputStep, 0};
+
+            const std::size_t remaining = ZSTD_compressStream2(context_, &buffer, &in, mode);
+            out.resize(used + buffer.pos);
+            if (ZSTD_isError(remaining)) {
+                throw std::runtime_error("[ERROR] ZstdEncoder: compression failed.");
+            }
+            if (mode == ZSTD_e_end ? remaining == 0 : in.pos == in.size) {
+                return;
+            }
+        }
+    }
+};
+#endif
+
+std::chrono::nanoseconds thread_cpu_time() {
+    timespec now{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+}
+
+struct EncodingMetrics {
+    metrics::Counter* bytes_in = nullptr;
+    metrics::Counter* bytes_out = nullptr;
+    metrics::Histogram* cpu = nullptr;
+};
+
+const EncodingMetrics& metrics_for(ContentEncoding encoding) {
+    static const auto table = [] {
+        std::array<EncodingMetrics, 4> table{};
+        for (const auto e : {ContentEncoding::GZIP, ContentEncoding::BROTLI, ContentEncoding::ZSTD}) {
+            const std::string labels = metrics::labels({{"encoding", encoding_name(e)}});
+            auto& registry = metrics::registry();
+            auto& m = table[static_cast<std::size_t>(e)];
+            m.bytes_in = &registry.counter(
+                "taskfarmer_http_compression_input_bytes_total",
+                "Response bytes before compression.", labels);
+            m.bytes_out = &registry.counter(
+                "taskfarmer_http_compression_output_bytes_total",
+                "Response bytes after compression.", labels);
+            m.cpu = &registry.histogram(
+                "taskfarmer_http_compression_cpu_seconds",
+                "Thread CPU time spent compressing one response.", labels);
+        }
+        return table;
+    }();
+    return table[static_cast<std::size_t>(encoding)];
+}
+
+bool equals_ignore_case(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// Built-in encodings, most preferred first.
+constexpr std::array kPreference = {
+#ifdef TASKFARMER_WITH_ZSTD
+    ContentEncoding::ZSTD,
+#endif
+#ifdef TASKFARMER_WITH_BROTLI
+    ContentEncoding::BROTLI,
+#endif
+    ContentEncoding::GZIP,
+};
+
+} // namespace
+
+void validate(const CompressionConfig& config) {
+    if (config.gzip_level < 1 || config.gzip_level > 9) {
+        throw std::runtime_error("[ERROR] compression: gzip_level must be within [1, 9].");
+    }
+    if (config.brotli_quality < 0 || config.brotli_quality > 11) {
+        throw std::runtime_error("[ERROR] compression: brotli_quality must be within [0, 11].");
+    }
+    if (config.zstd_level < 1 || config.zstd_level > 19) {
+        throw std::runtime_error("[ERROR] compression: zstd_level must be within [1, 19].");
+    }
+}
+
+std::string_view encoding_name(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::GZIP:   return "gzip";
+        case ContentEncoding::BROTLI: return "br";
+        case ContentEncoding::ZSTD:   return "zstd";
+        case ContentEncoding::IDENTITY: break;
+    }
+    return "identity";
+}
+
+ContentEncoding negotiate(std::string_view accept_encoding) {
+    // q-values of the built-in encodings, in kPreference order; -1 unlisted.
+    std::array<double, kPreference.size()> q;
+    q.fill(-1.0);
+    double wildcard = -1.0;
+
+    while (!accept_encoding.empty()) {
+        const auto comma = accept_encoding.find(',');
+        std::string_view item = accept_encoding.substr(0, comma);
+        accept_encoding = comma == std::string_view::npos
+            ? std::string_view{}
+            : accept_encoding.substr(comma + 1);
+
+        double value = 1.0;
+        const auto semicolon = item.find(';');
+        if (semicolon != std::string_view::npos) {
+            std::string_view param = trim(item.substr(semicolon + 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                param.remove_prefix(2);
+                if (std::from_chars(param.data(), param.data() + param.size(), value).ec !=
+                    std::errc()) {
+                    value = 0.0;
+                }
+            }
+            item = item.substr(0, semicolon);
+        }
+        item = trim(item);
+
+        if (item == "*") {
+            wildcard = value;
+            continue;
+        }
+        for (std::size_t i = 0; i < kPreference.size(); ++i) {
+            if (equals_ignore_case(item, encoding_name(kPreference[i]))) {
+                q[i] = value;
+            }
+        }
+    }
+
+    ContentEncoding best = ContentEncoding::IDENTITY;
+    double best_q = 0.0;
+    for (std::size_t i = 0; i < kPreference.size(); ++i) {
+        const double value = q[i] >= 0.0 ? q[i] : wildcard;
+        if (value > best_q) {
+            best = kPreference[i];
+            best_q = value;
+        }
+    }
+    return best;
+}
+
+bool compressible(std::string_view content_type) {
+    return content_type.starts_with("application/json") || content_type.starts_with("text/");
+}
+
+Compressor::Compressor(ContentEncoding encoding, const CompressionConfig& config)
+    : encoding_(encoding) {
+    switch (encoding) {
+        case ContentEncoding::GZIP:
+            encoder_ = std::make_unique<GzipEncoder>(config.gzip_level);
+            return;
+#ifdef TASKFARMER_WITH_BROTLI
+        case ContentEncoding::BROTLI:
+            encoder_ = std::make_unique<BrotliEncoder>(config.brotli_quality);
+            return;
+#endif
+#ifdef TASKFARMER_WITH_ZSTD
+        case ContentEncoding::ZSTD:
+            encoder_ = std::make_unique<ZstdEncoder>(config.zstd_level);
+            return;
+#endif
+        default:
+            break;
+    }
+    throw std::runtime_error("[ERROR] Compressor: encoding not built in.");
+}
+
+Compressor::~Compressor() = default;
+
+void Compressor::update(std::string_view input, std::string& out) {
+    const auto start = thread_cpu_time();
+    const std::size_t before = out.size();
+
+    encoder_->update(input, out);
+
+    bytes_in_ += input.size();
+    bytes_out_ += out.size() - before;
+    cpu_ += thread_cpu_time() - start;
+}
+
+void Compressor::finish(std::string& out) {
+    const auto start = thread_cpu_time();
+    const std::size_t before = out.size();
+
+    encoder_->finish(out);
+
+    bytes_out_ += out.size() - before;
+    cpu_ += thread_cpu_time() - start;
+
+    const EncodingMetrics& m = metrics_for(encoding_);
+    m.bytes_in->add(bytes_in_);
+    m.bytes_out->add(bytes_out_);
+    m.cpu->observe_ns(static_cast<std::uint64_t>(cpu_.count()));
+}
+
+std::string compress(ContentEncoding encoding, const CompressionConfig& config,
+                     std::string_view input) {
+    Compressor compressor(encoding, config);
+    std::string out;
+    out.reserve(input.size() / 4 + 64);
+    compressor.update(input, out);
+    compressor.finish(out);
+    return out;
+}
+
+} // namespace compression
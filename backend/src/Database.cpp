@@ -1,10 +1,14 @@
 // Database.cpp
 #include "../include/Database.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <ctime>
 #include <stdexcept>
+#include <unordered_map>
 
-Database::Database(std::string db_path) : db_path_(std::move(db_path)) {}
+Database::Database(std::string db_path, DatabaseAccess access)
+    : db_path_(std::move(db_path)), access_(access) {}
 
 Database::~Database() { close(); }
 
@@ -13,7 +17,12 @@ void Database::open() {
         return;
     }
 
-    const int rc = sqlite3_open(db_path_.c_str(), &db_);
+    // A read-only connection belongs to one thread at a time, so SQLite's
+    // per-connection mutex is skipped for it.
+    const int flags = read_only()
+        ? SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX
+        : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    const int rc = sqlite3_open_v2(db_path_.c_str(), &db_, flags, nullptr);
 
     if (rc != SQLITE_OK) {
         std::string error_msg{"[ERROR] sqlite3_open failed"};
@@ -29,6 +38,14 @@ void Database::open() {
         throw std::runtime_error(error_msg);
     }
 
+    if (read_only()) {
+        // journal_mode is persistent and set by the writer; WAL is what
+        // lets these connections read while it commits.
+        exec("PRAGMA query_only = ON;");
+        exec("PRAGMA busy_timeout = 3000;");
+        return;
+    }
+
     exec("PRAGMA foreign_keys = ON;");
     exec("PRAGMA journal_mode = WAL;");
     exec("PRAGMA synchronous = NORMAL;");
@@ -39,8 +56,18 @@ void Database::close() {
     if (db_ == nullptr) {
         return;
     }
+    statements_.clear();
     sqlite3_close(db_);
     db_ = nullptr;
+    schema_initialised_ = false;
+}
+
+Statement Database::prepare(std::string_view sql, std::string_view context) const {
+    return statements_.acquire(db_, sql, context);
+}
+
+StatementCache::Stats Database::statement_cache_stats() const {
+    return statements_.stats();
 }
 
 void Database::exec(std::string_view sql) const {
@@ -63,13 +90,28 @@ void Database::exec(std::string_view sql) const {
     }
 }
 
-void Database::throw_sqlite(sqlite3* db, int rc, std::string_view context) {
-    if (rc == SQLITE_OK || rc == SQLITE_ROW || rc == SQLITE_DONE) {
-        return;
-    }
+void Database::begin() {
+    prepare("BEGIN IMMEDIATE;", "begin").run();
+}
+
+void Database::commit() {
+    prepare("COMMIT;", "commit").run();
+}
+
+void Database::rollback() {
+    prepare("ROLLBACK;", "rollback").run();
+}
+
+void Database::savepoint(std::string_view name) {
+    prepare("SAVEPOINT " + std::string(name) + ";", "savepoint").run();
+}
 
-    const char* err = db ? sqlite3_errmsg(db) : "sqlite error";
-    throw std::runtime_error(std::string(context) + ": " + err);
+void Database::release_savepoint(std::string_view name) {
+    prepare("RELEASE " + std::string(name) + ";", "release_savepoint").run();
+}
+
+void Database::rollback_to_savepoint(std::string_view name) {
+    prepare("ROLLBACK TO " + std::string(name) + ";", "rollback_to_savepoint").run();
 }
 
 void Database::init_schema() {
@@ -77,6 +119,14 @@ void Database::init_schema() {
         throw std::runtime_error("init_schema: database is not open");
     }
 
+    if (schema_initialised_) {
+        return;
+    }
+
+    if (read_only()) {
+        throw std::runtime_error("[ERROR] init_schema: connection is read-only.");
+    }
+
     {
         char* err_msg = nullptr;
         const char* sql = R"sql(
@@ -88,7 +138,8 @@ void Database::init_schema() {
                 status      INTEGER NOT NULL,
                 priority    INTEGER NOT NULL,
                 created_at  INTEGER NOT NULL,
-                updated_at  INTEGER NOT NULL
+                updated_at  INTEGER NOT NULL,
+                path        TEXT
             );
         )sql";
 
@@ -181,11 +232,15 @@ void Database::init_schema() {
         }
     }
 
+    migrate_schema();
+
     {
         char* err_msg = nullptr;
         const char* sql = R"sql(
             CREATE INDEX IF NOT EXISTS idx_tasks_parent_id
             ON tasks(parent_id);
+            CREATE INDEX IF NOT EXISTS idx_tasks_path
+            ON tasks(path);
             CREATE INDEX IF NOT EXISTS idx_user_roles_user_id
             ON user_roles(user_id);
             CREATE INDEX IF NOT EXISTS idx_user_roles_role_name
@@ -205,163 +260,451 @@ void Database::init_schema() {
         }
     }
 
+    {
+        // Full-text index over tasks.title/description. It is an external
+        // content table (the text lives only in tasks) keyed by tasks.rowid,
+        // kept in step by triggers so every write path, including the
+        // recursive delete in delete_subtree, updates it.
+        bool had_search_index = false;
+        {
+            Statement stmt = prepare(
+                "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'tasks_fts';",
+                "init_schema");
+            had_search_index = stmt.step();
+        }
+
+        char* err_msg = nullptr;
+        const char* sql = R"sql(
+            CREATE VIRTUAL TABLE IF NOT EXISTS tasks_fts USING fts5(
+                title,
+                description,
+                content = 'tasks',
+                content_rowid = 'rowid',
+                tokenize = 'unicode61 remove_diacritics 2'
+            );
+
+            INSERT INTO tasks_fts(tasks_fts, rank) VALUES ('rank', 'bm25(10.0, 1.0)');
+
+            CREATE TRIGGER IF NOT EXISTS tasks_fts_insert AFTER INSERT ON tasks
+            BEGIN
+                INSERT INTO tasks_fts(rowid, title, description)
+                VALUES (new.rowid, new.title, new.description);
+            END;
+
+            CREATE TRIGGER IF NOT EXISTS tasks_fts_delete AFTER DELETE ON tasks
+            BEGIN
+                INSERT INTO tasks_fts(tasks_fts, rowid, title, description)
+                VALUES ('delete', old.rowid, old.title, old.description);
+            END;
+
+            CREATE TRIGGER IF NOT EXISTS tasks_fts_update
+            AFTER UPDATE OF title, description ON tasks
+            BEGIN
+                INSERT INTO tasks_fts(tasks_fts, rowid, title, description)
+                VALUES ('delete', old.rowid, old.title, old.description);
+                INSERT INTO tasks_fts(rowid, title, description)
+                VALUES (new.rowid, new.title, new.description);
+            END;
+        )sql";
+
+        const int rc = sqlite3_exec(db_, sql, nullptr, nullptr, &err_msg);
+        if (rc != SQLITE_OK) {
+            std::string msg = "Couldn't create search index: ";
+            if (err_msg) {
+                msg += err_msg;
+                sqlite3_free(err_msg);
+            } else {
+                msg += sqlite3_errmsg(db_);
+            }
+            throw std::runtime_error(msg);
+        }
+
+        // Databases created before the index existed: index existing rows.
+        if (!had_search_index) {
+            rebuild_search_index();
+        }
+    }
 
+    schema_initialised_ = true;
 }
 
-std::string Database::ensure_root(std::string root_id, std::string root_title) {
-    open();
-    init_schema();
+void Database::migrate_schema() {
+    int version = 0;
+    {
+        Statement stmt = prepare("PRAGMA user_version;", "migrate_schema");
+        if (stmt.step()) {
+            version = sqlite3_column_int(stmt.get(), 0);
+        }
+    }
 
-    sqlite3_stmt* stmt = nullptr;
+    if (version >= kSchemaVersion) {
+        return;
+    }
 
-    const char* sql = R"sql(
-        INSERT OR IGNORE INTO tasks
-            (id, parent_id, title, description, status, priority, created_at,
-             updated_at)
-        VALUES
-            (?, NULL, ?, '', ?, ?, ?, ?);
-    )sql";
+    begin();
+    try {
+        if (version < 1) {
+            // v1: materialised id path. Tables created before it lack the
+            // column; fill it in from parent_id with one recursive walk.
+            bool has_path = false;
+            {
+                Statement stmt = prepare("PRAGMA table_info(tasks);", "migrate_schema");
+                while (stmt.step()) {
+                    const char* name =
+                        reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1));
+                    has_path = has_path || (name && std::string_view{name} == "path");
+                }
+            }
 
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    throw_sqlite(db_, rc, "ensure_root: prepare");
+            if (!has_path) {
+                exec("ALTER TABLE tasks ADD COLUMN path TEXT;");
+            }
 
-    const sqlite3_int64 ts = static_cast<sqlite3_int64>(std::time(nullptr));
+            exec(R"sql(
+                CREATE TEMP TABLE migrate_paths (
+                    id   TEXT PRIMARY KEY,
+                    path TEXT NOT NULL
+                ) WITHOUT ROWID;
+
+                WITH RECURSIVE walk(id, path) AS (
+                    SELECT id, id || '/' FROM tasks WHERE parent_id IS NULL
+                    UNION ALL
+                    SELECT tasks.id, walk.path || tasks.id || '/'
+                    FROM tasks
+                    JOIN walk ON tasks.parent_id = walk.id
+                )
+                INSERT INTO migrate_paths(id, path) SELECT id, path FROM walk;
+
+                UPDATE tasks
+                SET path = (SELECT path FROM migrate_paths WHERE migrate_paths.id = tasks.id)
+                WHERE path IS NULL;
+
+                DROP TABLE migrate_paths;
+            )sql");
+        }
 
-    rc = sqlite3_bind_text(stmt, 1, root_id.c_str(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "ensure_root: bind root_id");
+        exec("PRAGMA user_version = " + std::to_string(kSchemaVersion) + ";");
+        commit();
+    } catch (...) {
+        rollback();
+        throw;
     }
+}
 
-    rc = sqlite3_bind_text(stmt, 2, root_title.c_str(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "ensure_root: bind root_title");
+std::string Database::subtree_upper_bound(std::string_view path) {
+    // Every descendant's path extends `path`; appending the largest code
+    // point gives an exclusive upper bound for an index range scan.
+    return std::string{path} + "\xF4\x8F\xBF\xBF";
+}
+
+std::optional<std::string> Database::get_task_id_path(std::string_view id) const {
+    if (db_ == nullptr) {
+        throw std::runtime_error(
+            "[ERROR] Tried to run get_task_id_path but database is uninitialised."
+        );
     }
 
-    rc = sqlite3_bind_int(stmt, 3, static_cast<int>(TaskStatus::TODO));
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "ensure_root: bind status");
+    Statement stmt = prepare("SELECT path FROM tasks WHERE id = ?;", "get_task_id_path");
+    stmt.bind_text(1, id);
+
+    if (!stmt.step() || sqlite3_column_type(stmt.get(), 0) == SQLITE_NULL) {
+        return std::nullopt;
     }
+    return std::string{reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0))};
+}
 
-    rc = sqlite3_bind_int(stmt, 4, static_cast<int>(TaskPriority::MEDIUM));
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "ensure_root: bind priority");
+std::size_t Database::count_descendants(std::string_view id) const {
+    const std::optional<std::string> path = get_task_id_path(id);
+    if (!path) {
+        return 0;
     }
 
-    rc = sqlite3_bind_int64(stmt, 5, ts);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "ensure_root: bind created_at");
+    // Covered by idx_tasks_path: counts index entries in the range only.
+    const char* sql = R"sql(
+        SELECT COUNT(*) FROM tasks WHERE path > ? AND path < ?;
+    )sql";
+
+    Statement stmt = prepare(sql, "count_descendants");
+    const std::string upper = subtree_upper_bound(*path);
+    stmt.bind_text(1, *path);
+    stmt.bind_text(2, upper);
+    stmt.step();
+    return static_cast<std::size_t>(sqlite3_column_int64(stmt.get(), 0));
+}
+
+bool Database::is_ancestor_of(std::string_view ancestor_id,
+                              std::string_view descendant_id) const {
+    if (db_ == nullptr) {
+        throw std::runtime_error(
+            "[ERROR] Tried to run is_ancestor_of but database is uninitialised."
+        );
     }
 
-    rc = sqlite3_bind_int64(stmt, 6, ts);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "ensure_root: bind updated_at");
+    // Two primary-key lookups and a prefix compare.
+    const char* sql = R"sql(
+        SELECT 1
+        FROM tasks AS a, tasks AS d
+        WHERE a.id = ?
+          AND d.id = ?
+          AND length(d.path) > length(a.path)
+          AND substr(d.path, 1, length(a.path)) = a.path;
+    )sql";
+
+    Statement stmt = prepare(sql, "is_ancestor_of");
+    stmt.bind_text(1, ancestor_id);
+    stmt.bind_text(2, descendant_id);
+    return stmt.step();
+}
+
+std::optional<std::string> Database::render_path(std::string_view id) const {
+    const std::optional<std::string> id_path = get_task_id_path(id);
+    if (!id_path) {
+        return std::nullopt;
     }
 
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "ensure_root: step");
+    // One primary-key lookup per ancestor below the root, read off the
+    // stored id path instead of following parent_id row by row.
+
+    std::string out;
+    std::string_view rest = *id_path;
+    bool is_root = true;
+    while (!rest.empty()) {
+        const auto slash = rest.find('/');
+        const std::string_view segment = rest.substr(0, slash);
+        rest.remove_prefix(slash == std::string_view::npos ? rest.size() : slash + 1);
+
+        if (is_root) {
+            is_root = false;
+            continue;
+        }
+
+        Statement title = prepare("SELECT title FROM tasks WHERE id = ?;", "render_path");
+        title.bind_text(1, segment);
+        if (!title.step()) {
+            return std::nullopt;
+        }
+        out += '/';
+        out += reinterpret_cast<const char*>(sqlite3_column_text(title.get(), 0));
     }
 
-    sqlite3_finalize(stmt);
-    return root_id;
+    return out + "/";
 }
 
-TaskNode Database::load_root() {
-    std::string root_id{ensure_root()};
-    std::optional<TaskNode> root_node{get_task_by_id(root_id)};
+void Database::rebuild_search_index() {
+    exec("INSERT INTO tasks_fts(tasks_fts) VALUES ('rebuild');");
+}
 
-    if (!root_node.has_value()) {
+std::string Database::fts_query(std::string_view text) {
+    // Every whitespace-separated term becomes a quoted string, so FTS5
+    // operators typed by the user are matched literally; terms are ANDed.
+    std::string out;
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+        std::size_t end = pos;
+        while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))) {
+            ++end;
+        }
+        if (end == pos) {
+            break;
+        }
+
+        if (!out.empty()) {
+            out.push_back(' ');
+        }
+        out.push_back('"');
+        for (const char c : text.substr(pos, end - pos)) {
+            if (c == '"') {
+                out.push_back('"');
+            }
+            out.push_back(c);
+        }
+        out.push_back('"');
+        pos = end;
+    }
+    return out;
+}
+
+std::vector<Database::SearchHit> Database::search_tasks(std::string_view text,
+                                                        std::size_t limit,
+                                                        std::size_t offset) const {
+    if (db_ == nullptr) {
         throw std::runtime_error(
-            "[EsRROR] Tc node does not exist in DB. load_root"
+            "[ERROR] Tried to run search_tasks but database is uninitialised."
         );
-    } else {
-        return root_node.value();
     }
+
+    const std::string match = fts_query(text);
+    if (match.empty()) {
+        return {};
+    }
+
+    // Ranking and the LIMIT run inside FTS5 on the index alone (rank is
+    // configured as bm25 with title weighted over description); tasks is
+    // joined only for the rows of the page.
+    //
+    // bm25 costs a lookup per matching row, so a term found in most of a
+    // million tasks would take over a second to rank. Only the newest
+    // kSearchRankWindow matches are ranked: the inner subquery finds the
+    // rowid of the window-th newest match (by walking the doclist, which is
+    // cheap) and the ranked query is restricted to rowids from there on.
+    // The window does not depend on offset, so every page is cut from the
+    // same ranking. Queries with fewer matches than the window are ranked
+    // exactly.
+    const std::size_t window = kSearchRankWindow;
+
+    const char* sql = R"sql(
+        SELECT
+            t.id,
+            t.title,
+            t.description,
+            t.status,
+            t.priority,
+            t.created_at,
+            t.updated_at,
+            t.parent_id,
+            hits.rank
+        FROM (
+            SELECT rowid, rank
+            FROM tasks_fts
+            WHERE tasks_fts MATCH ?1
+              AND rowid >= IFNULL((
+                  SELECT rowid
+                  FROM tasks_fts
+                  WHERE tasks_fts MATCH ?1
+                  ORDER BY rowid DESC
+                  LIMIT 1 OFFSET ?4
+              ), -9223372036854775808)
+            ORDER BY rank
+            LIMIT ?2 OFFSET ?3
+        ) AS hits
+        JOIN tasks AS t ON t.rowid = hits.rowid
+        ORDER BY hits.rank;
+    )sql";
+
+    Statement stmt = prepare(sql, "search_tasks");
+    stmt.bind_text(1, match);
+    stmt.bind_int64(2, static_cast<sqlite3_int64>(limit));
+    stmt.bind_int64(3, static_cast<sqlite3_int64>(offset));
+    stmt.bind_int64(4, static_cast<sqlite3_int64>(window - 1));
+
+    std::vector<SearchHit> hits;
+    while (stmt.step()) {
+        const char* parent_text =
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 7));
+        hits.push_back(SearchHit{
+            hydrate_task(stmt.get()),
+            parent_text ? parent_text : "",
+            sqlite3_column_double(stmt.get(), 8)
+        });
+    }
+    return hits;
 }
 
-bool Database::insert_task(const TaskNode& node, const std::string& parent_id) {
+std::string Database::ensure_root(std::string root_id, std::string root_title) {
     open();
     init_schema();
 
-    sqlite3_stmt* stmt = nullptr;
-
     const char* sql = R"sql(
-        INSERT INTO tasks
-            (id, parent_id, title, description, status, priority, created_at, updated_at)
+        INSERT OR IGNORE INTO tasks
+            (id, parent_id, title, description, status, priority, created_at,
+             updated_at, path)
         VALUES
-            (?, ?, ?, ?, ?, ?, ?, ?);
+            (?1, NULL, ?2, '', ?3, ?4, ?5, ?6, ?1 || '/');
     )sql";
 
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        throw_sqlite(db_, rc, "insert task: prepare");
-    }
+    Statement stmt = prepare(sql, "ensure_root");
 
     const sqlite3_int64 ts = static_cast<sqlite3_int64>(std::time(nullptr));
 
-    rc = sqlite3_bind_text(stmt, 1, node.get_id().c_str(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "id binding to statement.");
-    }
+    stmt.bind_text(1, root_id);
+    stmt.bind_text(2, root_title);
+    stmt.bind_int(3, static_cast<int>(TaskStatus::TODO));
+    stmt.bind_int(4, static_cast<int>(TaskPriority::MEDIUM));
+    stmt.bind_int64(5, ts);
+    stmt.bind_int64(6, ts);
+    stmt.run();
 
-    rc = sqlite3_bind_text(stmt, 2, parent_id.c_str(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "parent id binding to statement");
-    }
+    return root_id;
+}
 
-    rc = sqlite3_bind_text(stmt, 3, node.get_title().c_str(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "title binding to statement");
-    }
+TaskNode Database::load_root() {
+    std::string root_id{ensure_root()};
+    std::optional<TaskNode> root_node{get_task_by_id(root_id)};
 
-    rc = sqlite3_bind_text(stmt, 4, node.get_description().c_str(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "description binding to statement");
+    if (!root_node.has_value()) {
+        throw std::runtime_error(
+            "[EsRROR] Tc node does not exist in DB. load_root"
+        );
+    } else {
+        return std::move(*root_node);
     }
+}
 
-    rc = sqlite3_bind_int(stmt, 5, static_cast<int>(node.get_status()));
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "status binding to statement");
-    }
+bool Database::insert_task(const TaskNode& node, const std::string& parent_id) {
+    open();
+    init_schema();
 
-    rc = sqlite3_bind_int(stmt, 6, static_cast<int>(node.get_priority()));
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "priority binding to statement");
-    }
+    // The id path is derived from the parent's in the same statement, so
+    // it is written atomically with the row.
+    const char* sql = R"sql(
+        INSERT INTO tasks
+            (id, parent_id, title, description, status, priority, created_at, updated_at,
+             path)
+        VALUES
+            (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8,
+             (SELECT path FROM tasks WHERE id = ?2) || ?1 || '/');
+    )sql";
 
-    rc = sqlite3_bind_int64(stmt, 7, ts);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "created_at binding to statement");
-    }
+    Statement stmt = prepare(sql, "insert_task");
 
-    rc = sqlite3_bind_int64(stmt, 8, ts);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "updated_at binding to statement");
-    }
+    stmt.bind_text(1, node.get_id());
+    stmt.bind_text(2, parent_id);
+    stmt.bind_text(3, node.get_title());
+    stmt.bind_text(4, node.get_description());
+    stmt.bind_int(5, static_cast<int>(node.get_status()));
+    stmt.bind_int(6, static_cast<int>(node.get_priority()));
+    stmt.bind_int64(7, static_cast<sqlite3_int64>(node.get_created_at()));
+    stmt.bind_int64(8, static_cast<sqlite3_int64>(node.get_updated_at()));
+    stmt.run();
 
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "insert task: step");
+    return true;
+}
+
+TaskNode Database::hydrate_task(sqlite3_stmt* stmt) {
+    const char* id_text =
+        reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    const char* title_text =
+        reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    const char* description_text =
+        reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    const int status_integer = sqlite3_column_int(stmt, 3);
+    const int priority_integer = sqlite3_column_int(stmt, 4);
+    const std::time_t created_at_time =
+        static_cast<std::time_t>(sqlite3_column_int64(stmt, 5));
+    const std::time_t updated_at_time =
+        static_cast<std::time_t>(sqlite3_column_int64(stmt, 6));
+
+    // The enums index the rollup and facet arrays; a row written by some
+    // other tool must not take them out of bounds.
+    if (!is_valid_status(status_integer) || !is_valid_priority(priority_integer)) {
+        throw std::runtime_error(
+            "[ERROR] hydrate_task: task " + std::string(id_text ? id_text : "") +
+            " has an invalid status or priority."
+        );
     }
 
-    sqlite3_finalize(stmt);
-    return true;
+    return TaskNode(
+        id_text ? id_text : "",
+        title_text ? title_text : "",
+        description_text ? description_text : "",
+        static_cast<TaskStatus>(status_integer),
+        static_cast<TaskPriority>(priority_integer),
+        created_at_time,
+        updated_at_time
+    );
 }
 
 std::optional<TaskNode> Database::get_task_by_id(std::string_view id) const {
@@ -386,61 +729,16 @@ std::optional<TaskNode> Database::get_task_by_id(std::string_view id) const {
             id = ?;
     )sql";
 
-    sqlite3_stmt* stmt = nullptr;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    throw_sqlite(db_, rc, "get_task_by_id prepare stmt");
+    Statement stmt = prepare(sql, "get_task_by_id");
+    stmt.bind_text(1, id);
 
-    rc = sqlite3_bind_text(stmt, 1, id.data(), static_cast<int>(id.size()), SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "get_task_by_id bind id");
-    }
-
-    rc = sqlite3_step(stmt);
-
-    if (rc == SQLITE_ROW) {
-        const char* id_text =
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        const char* title_text =
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        const char* description_text =
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        const int status_integer = sqlite3_column_int(stmt, 3);
-        const int priority_integer = sqlite3_column_int(stmt, 4);
-        const std::time_t created_at_time =
-            static_cast<std::time_t>(sqlite3_column_int64(stmt, 5));
-        const std::time_t updated_at_time =
-            static_cast<std::time_t>(sqlite3_column_int64(stmt, 6));
-
-        TaskNode node(
-            id_text ? id_text : "",
-            title_text ? title_text : "",
-            description_text ? description_text : "",
-            static_cast<TaskStatus>(status_integer),
-            static_cast<TaskPriority>(priority_integer),
-            created_at_time,
-            updated_at_time
-        );
-
-        sqlite3_finalize(stmt);
-        return node;
-    }
-
-    if (rc == SQLITE_DONE) {
-        sqlite3_finalize(stmt);
+    if (!stmt.step()) {
         return std::nullopt;
     }
 
-    sqlite3_finalize(stmt);
-    throw_sqlite(db_, rc, "get_task_by_id step.");
-    return std::nullopt;
+    return hydrate_task(stmt.get());
 }
 
-/*
- *  This is the N + 1, where this method runs an sql query and we run another sql query.
- *  Pretty Inefficient. So fix this later. Too cbs right now.
- */
-
 std::vector<TaskNode> Database::list_children(std::string_view parent_id) const {
     if (db_ == nullptr) {
         throw std::runtime_error(
@@ -448,55 +746,36 @@ std::vector<TaskNode> Database::list_children(std::string_view parent_id) const
         );
     }
 
+    // Full rows in one statement; this used to select ids only and then call
+    // get_task_by_id for every child (one prepare + one round trip each).
     const char* sql = R"sql(
         SELECT
-            id
+            id,
+            title,
+            description,
+            status,
+            priority,
+            created_at,
+            updated_at
         FROM
             tasks
         WHERE
             parent_id = ?;
     )sql";
 
-    sqlite3_stmt* stmt = nullptr;
-
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    throw_sqlite(db_, rc, "preparing sqlite3 statement.");
-
-    rc = sqlite3_bind_text(
-        stmt,
-        1,
-        parent_id.data(),
-        static_cast<int>(parent_id.size()),
-        SQLITE_TRANSIENT
-    );
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "binding parent_id");
-    }
+    Statement stmt = prepare(sql, "list_children");
+    stmt.bind_text(1, parent_id);
 
     std::vector<TaskNode> child_nodes{};
 
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        const char* child_id_text =
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-
-        if (!child_id_text) {
-            sqlite3_finalize(stmt);
+    while (stmt.step()) {
+        if (sqlite3_column_type(stmt.get(), 0) == SQLITE_NULL) {
             throw std::runtime_error("[ERROR] Child id does not exist but it should.");
         }
 
-        auto child_node = get_task_by_id(child_id_text);
-        if (child_node.has_value()) {
-            child_nodes.push_back(child_node.value());
-        }
-    }
-
-    if (rc != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "The sql statement was not finished. list_children.");
+        child_nodes.push_back(hydrate_task(stmt.get()));
     }
 
-    sqlite3_finalize(stmt);
     return child_nodes;
 }
 
@@ -520,99 +799,88 @@ bool Database::update_task_fields(const TaskNode& node) {
             id = ?;
     )sql";
 
-    sqlite3_stmt* stmt = nullptr;
+    Statement stmt = prepare(sql, "update_task_fields");
 
-    const std::string& node_title = node.get_title();
-    const std::string& node_description = node.get_description();
-    TaskStatus node_status = node.get_status();
-    TaskPriority node_priority = node.get_priority();
-    std::time_t node_updated_at = node.get_updated_at();
-    const std::string& node_id = node.get_id();
+    stmt.bind_text(1, node.get_title());
+    stmt.bind_text(2, node.get_description());
+    stmt.bind_int(3, static_cast<int>(node.get_status()));
+    stmt.bind_int(4, static_cast<int>(node.get_priority()));
+    stmt.bind_int64(5, static_cast<sqlite3_int64>(node.get_updated_at()));
+    stmt.bind_text(6, node.get_id());
+    stmt.run();
 
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    throw_sqlite(db_, rc, "preparing sql statement.");
+    return sqlite3_changes(db_) == 1;
+}
 
-    rc = sqlite3_bind_text(
-        stmt,
-        1,
-        node_title.c_str(),
-        static_cast<int>(node_title.size()),
-        SQLITE_TRANSIENT
-    );
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "binding node title");
+TaskNode::Ptr Database::load_tree(std::string_view root_id) {
+    if (db_ == nullptr) {
+        throw std::runtime_error(
+            "[ERROR] Tried to run load_tree but database is uninitialised."
+        );
     }
 
-    rc = sqlite3_bind_text(
-        stmt,
-        2,
-        node_description.c_str(),
-        static_cast<int>(node_description.size()),
-        SQLITE_TRANSIENT
-    );
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "binding node description");
-    }
+    // One streaming scan over the table instead of a list_children +
+    // get_task_by_id round trip per node. A plain scan is an order of
+    // magnitude cheaper than walking idx_tasks_parent_id with a recursive
+    // CTE, but rows come back in rowid order, so a child may be read before
+    // its parent. Nodes are therefore created during the scan and linked by
+    // parent id afterwards, which keeps each parent's children in rowid
+    // (insertion) order as before.
+    const char* sql = R"sql(
+        SELECT
+            id,
+            title,
+            description,
+            status,
+            priority,
+            created_at,
+            updated_at,
+            parent_id
+        FROM
+            tasks;
+    )sql";
 
-    rc = sqlite3_bind_int(stmt, 3, static_cast<int>(node_status));
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "binding node status");
-    }
+    Statement stmt = prepare(sql, "load_tree");
 
-    rc = sqlite3_bind_int(stmt, 4, static_cast<int>(node_priority));
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "binding node priority");
-    }
+    std::vector<std::pair<TaskNode::Ptr, std::string>> rows;
+    std::unordered_map<std::string_view, TaskNode*> nodes_by_id;
 
-    rc = sqlite3_bind_int64(
-        stmt,
-        5,
-        static_cast<sqlite3_int64>(node_updated_at)
-    );
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "binding node updated_at time");
-    }
+    while (stmt.step()) {
+        const char* parent_text =
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 7));
 
-    rc = sqlite3_bind_text(
-        stmt,
-        6,
-        node_id.c_str(),
-        static_cast<int>(node_id.size()),
-        SQLITE_TRANSIENT
-    );
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "binding node id");
+        rows.emplace_back(
+            std::make_shared<TaskNode>(hydrate_task(stmt.get())),
+            parent_text ? parent_text : ""
+        );
     }
 
-    rc = sqlite3_step(stmt);
-
-    if (rc != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "[ERROR] Update task fields not completed.");
+    // Keys view each node's own id string, which outlives this function.
+    nodes_by_id.reserve(rows.size());
+    for (const auto& [node_ptr, parent_id] : rows) {
+        nodes_by_id.emplace(node_ptr->get_id(), node_ptr.get());
     }
 
-    sqlite3_finalize(stmt);
-    return true;
-}
+    TaskNode::Ptr root_ptr;
+    for (const auto& [node_ptr, parent_id] : rows) {
+        if (node_ptr->get_id() == root_id) {
+            root_ptr = node_ptr;
+        }
 
-TaskNode::Ptr Database::load_tree(std::string_view root_id) {
-    auto root_opt = get_task_by_id(root_id);
-    if (!root_opt.has_value()) {
-        throw std::runtime_error("[ERROR] load_tree: node id not found in DB.");
-    }
+        if (parent_id.empty()) {
+            continue;
+        }
 
-    TaskNode::Ptr root_ptr = std::make_shared<TaskNode>(root_opt.value());
+        // Rows whose parent no longer exists are unreachable from the
+        // workspace and are dropped, exactly as the recursive loader did.
+        const auto parent_it = nodes_by_id.find(parent_id);
+        if (parent_it != nodes_by_id.end()) {
+            parent_it->second->link_child(node_ptr);
+        }
+    }
 
-    std::vector<TaskNode> children = list_children(root_id);
-    for (const auto& child : children) {
-        TaskNode::Ptr child_ptr = load_tree(child.get_id());
-        root_ptr->add_child(child_ptr);
+    if (!root_ptr) {
+        throw std::runtime_error("[ERROR] load_tree: node id not found in DB.");
     }
 
     return root_ptr;
@@ -621,9 +889,13 @@ TaskNode::Ptr Database::load_tree(std::string_view root_id) {
 TaskNode Database::create_task_under(
     std::string_view parent_id,
     std::string title,
-    std::string description
+    std::string description,
+    TaskStatus status,
+    TaskPriority priority
 ) {
-    TaskNode node = TaskNode(title, description);
+    TaskNode node = TaskNode(std::move(title), std::move(description));
+    node.set_status(status);
+    node.set_priority(priority);
     insert_task(node, std::string(parent_id));
     return node;
 }
@@ -640,32 +912,11 @@ bool Database::insert_user_role(
             (?, ?);
     )sql";
 
-    sqlite3_stmt* stmt = nullptr;
+    Statement stmt = prepare(sql, "insert_user_role");
+    stmt.bind_text(1, user_id);
+    stmt.bind_text(2, role_string);
+    stmt.run();
 
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
-        throw_sqlite(db_, rc, "insert user role: prepare");
-    }
-
-    rc = sqlite3_bind_text(stmt, 1, user_id.data(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "user id binding to statement: insert user role");
-    }
-
-    rc = sqlite3_bind_text(stmt, 2, role_string.data(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "role string binding to statement");
-    }
-
-    rc = sqlite3_step(stmt);
-    if (rc != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "insert user role: step");
-    }
-
-    sqlite3_finalize(stmt);
     return true;
 }
 
@@ -678,88 +929,40 @@ bool Database::insert_user(std::string_view id, std::string_view name) {
             (?, ?);
     )sql";
 
-    sqlite3_stmt* stmt = nullptr;
+    Statement stmt = prepare(sql, "insert_user");
+    stmt.bind_text(1, id);
+    stmt.bind_text(2, name);
+    stmt.run();
 
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    return true;
+}
 
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "insert_user: prepare");
-    }
 
-    rc = sqlite3_bind_text(stmt, 1, id.data(), -1, SQLITE_TRANSIENT);
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "insert_user: binding id");
-    }
 
-    rc = sqlite3_bind_text(stmt, 2, name.data(), -1, SQLITE_TRANSIENT);
 
-    if (rc != SQLITE_OK) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "insert_user: binding name");
+bool Database::delete_subtree(std::string_view id) {
+    if (db_ == nullptr) {
+        throw std::runtime_error(
+            "[ERROR] Tried to run delete_subtree but database is uninitialised."
+        );
     }
 
-    rc = sqlite3_step(stmt);
-
-    if (rc != SQLITE_DONE) {
-        sqlite3_finalize(stmt);
-        throw_sqlite(db_, rc, "insert_user: step");
+    const std::optional<std::string> path = get_task_id_path(id);
+    if (!path) {
+        return false;
     }
 
-    sqlite3_finalize(stmt);
-    return true;
-}
-
-
+    // The node and its descendants are exactly the rows whose id path
+    // starts with the node's: one range over idx_tasks_path.
+    const char* sql = R"sql(
+        DELETE FROM tasks WHERE path >= ? AND path < ?;
+    )sql";
 
+    Statement stmt = prepare(sql, "delete_subtree");
+    const std::string upper = subtree_upper_bound(*path);
+    stmt.bind_text(1, *path);
+    stmt.bind_text(2, upper);
+    stmt.run();
 
-	bool Database::delete_subtree(std::string_view id) {
-	    if (db_ == nullptr) {
-	        throw std::runtime_error(
-	            "[ERROR] Tried to run delete_subtree but database is uninitialised."
-	        );
-	    }
-	
-	    const char* sql = R"sql(
-	        WITH RECURSIVE subtree(id) AS (
-	            SELECT id FROM tasks WHERE id = ?
-	            UNION ALL
-	            SELECT tasks.id
-	            FROM tasks
-	            JOIN subtree ON tasks.parent_id = subtree.id
-	        )
-	        DELETE FROM tasks WHERE id IN (SELECT id FROM subtree);
-	    )sql";
-	
-	    sqlite3_stmt* stmt = nullptr;
-	
-	    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-	    if (rc != SQLITE_OK) {
-	        sqlite3_finalize(stmt);
-	        throw_sqlite(db_, rc, "delete_subtree: prepare");
-	    }
-	
-	    rc = sqlite3_bind_text(
-	        stmt,
-	        1,
-	        id.data(),
-	        static_cast<int>(id.size()),
-	        SQLITE_TRANSIENT
-	    );
-	    if (rc != SQLITE_OK) {
-	        sqlite3_finalize(stmt);
-	        throw_sqlite(db_, rc, "delete_subtree: bind id");
-	    }
-	
-	    rc = sqlite3_step(stmt);
-	    if (rc != SQLITE_DONE) {
-	        sqlite3_finalize(stmt);
-	        throw_sqlite(db_, rc, "delete_subtree: step");
-	    }
-	
-	    const bool deleted = sqlite3_changes(db_) > 0;
-	
-	    sqlite3_finalize(stmt);
-	    return deleted;
-	}
\ No newline at end of file
+    return sqlite3_changes(db_) > 0;
+}
@@ -1,11 +1,363 @@
 #include "../include/HttpServer.hpp"
+#include "../include/TaskJson.hpp"
+#include "../include/WorkerPool.hpp"
 
 #include <nlohmann/json.hpp>
 
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
 using nlohmann::json;
 
-HttpServer::HttpServer(std::string host, int port, TaskService& service)
-    : host_(std::move(host)), port_(port), service_(service) {}
+namespace {
+
+using RouteClass = AdmissionController::RouteClass;
+
+struct RouteSpec {
+    const char* method;
+    const char* path;
+    RouteClass route_class;
+};
+
+// Every registered route, for the per-route request metrics and admission
+// control. Keep in step with setup_routes.
+constexpr std::array<RouteSpec, 11> kRoutes = {{
+    {"GET", "/health", RouteClass::EXEMPT},
+    {"GET", "/echo", RouteClass::EXEMPT},
+    {"GET", "/metrics", RouteClass::EXEMPT},
+    {"GET", "/api/ls", RouteClass::READ},
+    {"GET", "/api/query", RouteClass::READ},
+    {"GET", "/api/search", RouteClass::READ},
+    {"GET", "/api/tree", RouteClass::READ},
+    {"POST", "/api/create", RouteClass::WRITE},
+    {"POST", "/api/batch/create", RouteClass::BULK},
+    {"PATCH", "/api/modify", RouteClass::WRITE},
+    {"DELETE", "/api/delete", RouteClass::BULK},
+}};
+
+// "METHOD /path", the key of route_metrics_ and of admission routes.
+std::string route_key(const httplib::Request& req) {
+    std::string key;
+    key.reserve(req.method.size() + 1 + req.path.size());
+    key += req.method;
+    key.push_back(' ');
+    key += req.path;
+    return key;
+}
+
+// Set by the pre-routing handler and read by the logger, which httplib
+// runs on the same worker thread once the response has been written.
+thread_local std::chrono::steady_clock::time_point request_started;
+
+// The admission slot of the request the calling worker is serving,
+// released by the logger. httplib skips the logger when writing the
+// response fails, and then closes the connection, so the WorkerPool's
+// connection-end hook releases it too.
+thread_local AdmissionController::Ticket admission_ticket;
+
+// Whether `res` is sent in an encoding picked from Accept-Encoding: only
+// for enabled compression and a compressible content type not already
+// encoded.
+bool negotiated(const compression::CompressionConfig& config,
+                const httplib::Response& res,
+                std::string_view content_type) {
+    return config.enabled && !res.has_header("Content-Encoding") &&
+           compression::compressible(content_type);
+}
+
+// Set on every negotiated response, compressed or not: a cache that stored
+// the identity body for a client without Accept-Encoding must not hand it
+// to one that asked for gzip, nor the other way round.
+void vary_on_accept_encoding(httplib::Response& res) {
+    if (!res.has_header("Vary")) {
+        res.set_header("Vary", "Accept-Encoding");
+    }
+}
+
+// The encoding to send a negotiated response in, or IDENTITY if the client
+// accepts none of the built-in ones.
+compression::ContentEncoding response_encoding(const httplib::Request& req) {
+    return compression::negotiate(req.get_header_value("Accept-Encoding"));
+}
+
+void set_content_encoding(httplib::Response& res, compression::ContentEncoding encoding) {
+    res.set_header("Content-Encoding", std::string(compression::encoding_name(encoding)));
+    vary_on_accept_encoding(res);
+}
+
+// A streamed listing is compressed when it is likely to reach min_bytes;
+// every task serialises to more than this.
+constexpr std::size_t kMinTaskJsonBytes = 64;
+
+// Reads the optional integer fields "status" and "priority" of a task
+// body. A value that names no enumerator is an error message; absent or
+// non-integer fields leave `status`/`priority` as they are.
+std::string parse_enum_fields(const json& body,
+                              std::optional<TaskStatus>& status,
+                              std::optional<TaskPriority>& priority) {
+    if (body.contains("status") && body["status"].is_number_integer()) {
+        const auto value = body["status"].get<long long>();
+        if (!is_valid_status(value)) {
+            return "invalid field: status must be within [0, 3]";
+        }
+        status = static_cast<TaskStatus>(value);
+    }
+    if (body.contains("priority") && body["priority"].is_number_integer()) {
+        const auto value = body["priority"].get<long long>();
+        if (!is_valid_priority(value)) {
+            return "invalid field: priority must be within [0, 3]";
+        }
+        priority = static_cast<TaskPriority>(value);
+    }
+    return {};
+}
+
+// Limits for POST /api/batch/create.
+constexpr std::size_t kMaxBatchTasks = 50000;
+constexpr std::size_t kMaxBatchDepth = 64;
+
+// Parses one level of a batch body into drafts, recursing into "children".
+// Returns an error message, or an empty string on success.
+std::string parse_drafts(const json& items,
+                         std::size_t depth,
+                         std::size_t& count,
+                         std::vector<TaskDraft>& out) {
+    if (!items.is_array()) {
+        return "tasks/children must be an array";
+    }
+    if (depth > kMaxBatchDepth) {
+        return "task tree is nested too deeply";
+    }
+
+    out.reserve(items.size());
+    for (const auto& item : items) {
+        if (++count > kMaxBatchTasks) {
+            return "too many tasks in one batch";
+        }
+
+        if (!item.is_object() || !item.contains("title") || !item["title"].is_string()) {
+            return "missing/invalid field: title";
+        }
+
+        TaskDraft draft;
+        draft.title = item["title"].get<std::string>();
+
+        if (item.contains("description") && item["description"].is_string())
+            draft.description = item["description"].get<std::string>();
+
+        std::optional<TaskStatus> status;
+        std::optional<TaskPriority> priority;
+        if (std::string error = parse_enum_fields(item, status, priority); !error.empty()) {
+            return error;
+        }
+        draft.status = status.value_or(draft.status);
+        draft.priority = priority.value_or(draft.priority);
+
+        if (item.contains("children")) {
+            std::string error =
+                parse_drafts(item["children"], depth + 1, count, draft.children);
+            if (!error.empty()) {
+                return error;
+            }
+        }
+
+        out.push_back(std::move(draft));
+    }
+
+    return {};
+}
+
+// Reads an optional positive integer query param, clamped to [1, max].
+// Returns false if the value is not a number.
+bool size_param(const httplib::Request& req, const char* name,
+                std::size_t fallback, std::size_t max, std::size_t& out) {
+    out = fallback;
+    if (!req.has_param(name)) {
+        return true;
+    }
+    try {
+        const long long value = std::stoll(req.get_param_value(name));
+        out = static_cast<std::size_t>(std::clamp<long long>(value, 1, max));
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Page size limits for GET /api/ls?limit=.
+constexpr std::size_t kDefaultPageSize = 100;
+constexpr std::size_t kMaxPageSize = 1000;
+
+// Upper bound on results from a filtered listing.
+constexpr std::size_t kMaxQueryResults = 10000;
+
+// Splits a comma-separated query param into enum values, each given either
+// by name (as listed in `names`) or by its integer value.
+template <typename Enum, std::size_t N>
+bool enum_list_param(const httplib::Request& req, const char* name,
+                     const std::array<const char*, N>& names,
+                     std::vector<Enum>& out) {
+    if (!req.has_param(name)) {
+        return true;
+    }
+
+    std::string_view rest = req.get_param_value(name);
+    while (!rest.empty()) {
+        const auto comma = rest.find(',');
+        const std::string_view value = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+
+        std::size_t match = N;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (value == names[i] || value == std::to_string(i)) {
+                match = i;
+            }
+        }
+        if (match == N) {
+            return false;
+        }
+        out.push_back(static_cast<Enum>(match));
+    }
+    return true;
+}
+
+// Shared by /api/ls and /api/query:
+//   status=BLOCKED,1  priority=CRITICAL  updated_since=<unix seconds>
+//   sort=created_at|updated_at|priority|status|title (prefix '-' for
+//   descending)  limit=<n>
+// Returns an error message, or an empty string on success.
+std::string parse_task_query(const httplib::Request& req, TaskQuery& query) {
+    static constexpr std::array<const char*, 4> kStatusNames{
+        "TODO", "IN_PROGRESS", "COMPLETED", "BLOCKED"};
+    static constexpr std::array<const char*, 4> kPriorityNames{
+        "LOW", "MEDIUM", "HIGH", "CRITICAL"};
+
+    if (!enum_list_param(req, "status", kStatusNames, query.statuses)) {
+        return "invalid status filter";
+    }
+    if (!enum_list_param(req, "priority", kPriorityNames, query.priorities)) {
+        return "invalid priority filter";
+    }
+
+    if (req.has_param("updated_since")) {
+        try {
+            query.updated_since =
+                static_cast<std::time_t>(std::stoll(req.get_param_value("updated_since")));
+        } catch (...) {
+            return "updated_since must be a unix timestamp";
+        }
+    }
+
+    if (req.has_param("sort")) {
+        std::string_view sort = req.get_param_value("sort");
+        if (!sort.empty() && sort.front() == '-') {
+            query.descending = true;
+            sort.remove_prefix(1);
+        }
+
+        if (sort == "created_at") query.sort = TaskSortKey::CREATED_AT;
+        else if (sort == "updated_at") query.sort = TaskSortKey::UPDATED_AT;
+        else if (sort == "priority") query.sort = TaskSortKey::PRIORITY;
+        else if (sort == "status") query.sort = TaskSortKey::STATUS;
+        else if (sort == "title") query.sort = TaskSortKey::TITLE;
+        else return "unknown sort key";
+    }
+
+    if (!size_param(req, "limit", kMaxQueryResults, kMaxQueryResults, query.limit)) {
+        return "limit must be an integer";
+    }
+
+    return {};
+}
+
+bool has_query_params(const httplib::Request& req) {
+    return req.has_param("status") || req.has_param("priority") ||
+           req.has_param("updated_since") || req.has_param("sort");
+}
+
+void append_task_array(std::string& out, const std::vector<TaskNode::Ptr>& tasks) {
+    out.push_back('[');
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        task_json::append_task(out, *tasks[i]);
+    }
+    out.push_back(']');
+}
+
+// Page size limits for GET /api/search.
+constexpr std::size_t kDefaultSearchResults = 20;
+constexpr std::size_t kMaxSearchResults = 100;
+
+// Limits for GET /api/tree.
+constexpr std::size_t kDefaultTreeDepth = 2;
+constexpr std::size_t kMaxTreeDepth = 8;
+constexpr std::size_t kDefaultTreeNodes = 2000;
+constexpr std::size_t kMaxTreeNodes = 10000;
+
+void append_subtree(std::string& out, const std::vector<TaskSubtree>& nodes) {
+    out.push_back('[');
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        const auto& entry = nodes[i];
+        if (i > 0) {
+            out.push_back(',');
+        }
+        out.push_back('{');
+        task_json::append_task_fields(out, *entry.node);
+        out.push_back(',');
+        task_json::append_rollup(out, *entry.node);
+        out += entry.has_children ? ",\"has_children\":true" : ",\"has_children\":false";
+        if (entry.expanded) {
+            out += ",\"children\":";
+            append_subtree(out, entry.children);
+        }
+        out.push_back('}');
+    }
+    out.push_back(']');
+}
+
+} // namespace
+
+HttpServer::HttpServer(HttpServerConfig config, TaskService& service)
+    : config_(std::move(config)),
+      service_(service),
+      access_log_(config_.access_log),
+      admission_(config_.admission, config_.worker_threads) {
+    compression::validate(config_.compression);
+
+    // One family with a sample per built-in encoding, so it is rendered
+    // by the registry rather than appended per scrape.
+    const auto set_level = [](std::string_view encoding, int level) {
+        metrics::registry().gauge(
+            "taskfarmer_http_compression_level",
+            "Configured compression level, by encoding.",
+            metrics::labels({{"encoding", encoding}})
+        ).set(level);
+    };
+    set_level("gzip", config_.compression.gzip_level);
+#ifdef TASKFARMER_WITH_BROTLI
+    set_level("br", config_.compression.brotli_quality);
+#endif
+#ifdef TASKFARMER_WITH_ZSTD
+    set_level("zstd", config_.compression.zstd_level);
+#endif
+
+    if (config_.port < 0 || config_.port > 65535) {
+        throw std::runtime_error("[ERROR] HttpServer: port must be within [0, 65535].");
+    }
+    if (config_.worker_threads == 0) {
+        throw std::runtime_error("[ERROR] HttpServer: worker_threads must be positive.");
+    }
+    if (config_.keep_alive_max_count == 0) {
+        throw std::runtime_error("[ERROR] HttpServer: keep_alive_max_count must be positive.");
+    }
+}
 
 void HttpServer::set_json(httplib::Response& res, int status,
                           const std::string& body) {
@@ -14,7 +366,11 @@ void HttpServer::set_json(httplib::Response& res, int status,
 }
 
 void HttpServer::register_api_endpoint() {
-    // GET /api/ls?path=/Tetris%20Clone/Game%20Logic/
+    // GET /api/ls?parent_id=ROOT
+    // GET /api/ls?parent_id=ROOT&limit=100&cursor=...
+    // Without limit/cursor the whole listing is returned as an array. With
+    // either, one page is returned as {"items": [...], "next_cursor": ...},
+    // ordered by (created_at, id); next_cursor is null on the last page.
     server_.Get("/api/ls",
         [this](const httplib::Request& req, httplib::Response& res) {
             try {
@@ -25,22 +381,262 @@ void HttpServer::register_api_endpoint() {
 
                 const std::string parent_id = req.get_param_value("parent_id");
 
-                const auto children = service_.ls_by_parent_id(parent_id);
-
-                json out = json::array();
-                for (const auto& child : children) {
-                    out.push_back({
-                        {"id", child->get_id()},
-                        {"title", child->get_title()},
-                        {"description", child->get_description()},
-                        {"status", child->get_status()},
-                        {"priority", child->get_priority()},
-                        {"created_at", child->get_created_at()},
-                        {"last_updated_at", child->get_updated_at()}
-                    });
+                if (has_query_params(req)) {
+                    if (req.has_param("cursor")) {
+                        json j = {{"error", "cursor cannot be combined with filters or sort"}};
+                        return set_json(res, 400, j.dump());
+                    }
+
+                    TaskQuery query;
+                    const std::string error = parse_task_query(req, query);
+                    if (!error.empty()) {
+                        return set_json(res, 400, json{{"error", error}}.dump());
+                    }
+
+                    const TaskQueryResult result = service_.query_children(parent_id, query);
+
+                    std::string out;
+                    append_task_array(out, result.items);
+                    res.status = 200;
+                    res.set_content(std::move(out), "application/json");
+                    return;
                 }
 
-                return set_json(res, 200, out.dump());
+                if (req.has_param("limit") || req.has_param("cursor")) {
+                    std::size_t limit = 0;
+                    if (!size_param(req, "limit", kDefaultPageSize, kMaxPageSize, limit)) {
+                        json j = {{"error", "limit must be an integer"}};
+                        return set_json(res, 400, j.dump());
+                    }
+
+                    std::optional<ChildCursor> after;
+                    if (req.has_param("cursor")) {
+                        after = ChildCursor::decode(req.get_param_value("cursor"));
+                        if (!after) {
+                            json j = {{"error", "invalid cursor"}};
+                            return set_json(res, 400, j.dump());
+                        }
+                    }
+
+                    const ChildPage page = service_.ls_page(parent_id, after, limit);
+
+                    std::string out = "{\"items\":";
+                    append_task_array(out, page.items);
+                    out += ",\"next_cursor\":";
+                    if (page.next) {
+                        task_json::append_string(out, page.next->encode());
+                    } else {
+                        out += "null";
+                    }
+                    out.push_back('}');
+
+                    res.status = 200;
+                    res.set_content(std::move(out), "application/json");
+                    return;
+                }
+
+                std::vector<TaskNode::Ptr> tasks = service_.ls_by_parent_id(parent_id);
+
+                compression::ContentEncoding encoding = compression::ContentEncoding::IDENTITY;
+                if (negotiated(config_.compression, res, "application/json")) {
+                    vary_on_accept_encoding(res);
+                    if (tasks.size() * kMinTaskJsonBytes >= config_.compression.min_bytes) {
+                        encoding = response_encoding(req);
+                    }
+                }
+
+                auto stream = std::make_shared<TaskListingStream>(std::move(tasks));
+
+                // Streamed with chunked encoding, one bounded buffer at a
+                // time, so large listings never exist as a single string.
+                // The rows are the copies ls_by_parent_id made under the
+                // lock, so they cannot change while they are written out.
+                res.status = 200;
+                if (encoding == compression::ContentEncoding::IDENTITY) {
+                    res.set_chunked_content_provider(
+                        "application/json",
+                        [stream, chunk = std::string()](std::size_t, httplib::DataSink& sink) mutable {
+                            if (!stream->next(chunk)) {
+                                sink.done();
+                                return true;
+                            }
+                            return sink.write(chunk.data(), chunk.size());
+                        }
+                    );
+                    return;
+                }
+
+                // Compressed chunk by chunk. The encoder may hold a chunk
+                // back; nothing is written then, as an empty chunk would
+                // end the response.
+                set_content_encoding(res, encoding);
+                auto compressor = std::make_shared<compression::Compressor>(
+                    encoding, config_.compression);
+                res.set_chunked_content_provider(
+                    "application/json",
+                    [stream, compressor, chunk = std::string(), out = std::string()](
+                        std::size_t, httplib::DataSink& sink) mutable {
+                        out.clear();
+                        const bool more = stream->next(chunk);
+                        if (more) {
+                            compressor->update(chunk, out);
+                        } else {
+                            compressor->finish(out);
+                        }
+                        if (!out.empty() && !sink.write(out.data(), out.size())) {
+                            return false;
+                        }
+                        if (!more) {
+                            sink.done();
+                        }
+                        return true;
+                    }
+                );
+            } catch (const std::exception& e) {
+                json j = {{"error", e.what()}};
+                return set_json(res, 500, j.dump());
+            }
+        }
+    );
+
+    // GET /api/query?parent_id=ROOT&status=BLOCKED&priority=CRITICAL&sort=-updated_at
+    // Same filters as /api/ls, returned as {"matched": n, "items": [...]}
+    // where matched counts every hit before the limit.
+    server_.Get("/api/query",
+        [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                if (!req.has_param("parent_id")) {
+                    json j = {{"error", "missing required query param: parent_id"}};
+                    return set_json(res, 400, j.dump());
+                }
+
+                TaskQuery query;
+                const std::string error = parse_task_query(req, query);
+                if (!error.empty()) {
+                    return set_json(res, 400, json{{"error", error}}.dump());
+                }
+
+                const TaskQueryResult result =
+                    service_.query_children(req.get_param_value("parent_id"), query);
+
+                std::string out = "{\"matched\":" + std::to_string(result.matched);
+                out += ",\"items\":";
+                append_task_array(out, result.items);
+                out.push_back('}');
+
+                res.status = 200;
+                res.set_content(std::move(out), "application/json");
+            } catch (const std::exception& e) {
+                json j = {{"error", e.what()}};
+                return set_json(res, 500, j.dump());
+            }
+        }
+    );
+
+    // GET /api/search?q=collision&limit=20&offset=0
+    // Ranked full-text search over titles and descriptions. Each item is a
+    // task plus its "path" and bm25 "score" (lower is better); next_offset
+    // is null on the last page. Only the newest Database::kSearchRankWindow
+    // matches are ranked, so results end there.
+    server_.Get("/api/search",
+        [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                if (!req.has_param("q")) {
+                    json j = {{"error", "missing required query param: q"}};
+                    return set_json(res, 400, j.dump());
+                }
+
+                std::size_t limit = 0;
+                if (!size_param(req, "limit", kDefaultSearchResults, kMaxSearchResults, limit)) {
+                    json j = {{"error", "limit must be an integer"}};
+                    return set_json(res, 400, j.dump());
+                }
+
+                std::size_t offset = 0;
+                if (req.has_param("offset")) {
+                    try {
+                        offset = std::stoull(req.get_param_value("offset"));
+                    } catch (...) {
+                        json j = {{"error", "offset must be an integer"}};
+                        return set_json(res, 400, j.dump());
+                    }
+                }
+
+                const std::string q = req.get_param_value("q");
+
+                // One extra row tells us whether another page exists.
+                auto results = service_.search(q, limit + 1, offset);
+                const bool more = results.size() > limit;
+                if (more) {
+                    results.pop_back();
+                }
+
+                std::string out = "{\"query\":";
+                task_json::append_string(out, q);
+                out += ",\"items\":[";
+                for (std::size_t i = 0; i < results.size(); ++i) {
+                    if (i > 0) {
+                        out.push_back(',');
+                    }
+                    out.push_back('{');
+                    task_json::append_task_fields(out, *results[i].task);
+                    out += ",\"path\":";
+                    task_json::append_string(out, results[i].path);
+                    out += ",\"score\":" + json(results[i].score).dump();
+                    out.push_back('}');
+                }
+                out += "],\"next_offset\":";
+                out += more ? std::to_string(offset + limit) : "null";
+                out.push_back('}');
+
+                res.status = 200;
+                res.set_content(std::move(out), "application/json");
+            } catch (const std::exception& e) {
+                json j = {{"error", e.what()}};
+                return set_json(res, 500, j.dump());
+            }
+        }
+    );
+
+    // GET /api/tree?root_id=ROOT&depth=2&max_nodes=2000
+    // Returns up to `depth` levels below root_id as nested JSON. Nodes inside
+    // the depth carry a "children" array; every node reports has_children so
+    // the client knows which leaves can still be expanded.
+    server_.Get("/api/tree",
+        [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                if (!req.has_param("root_id")) {
+                    json j = {{"error", "missing required query param: root_id"}};
+                    return set_json(res, 400, j.dump());
+                }
+
+                std::size_t depth = 0;
+                std::size_t max_nodes = 0;
+                if (!size_param(req, "depth", kDefaultTreeDepth, kMaxTreeDepth, depth) ||
+                    !size_param(req, "max_nodes", kDefaultTreeNodes, kMaxTreeNodes, max_nodes)) {
+                    json j = {{"error", "depth/max_nodes must be integers"}};
+                    return set_json(res, 400, j.dump());
+                }
+
+                const std::string root_id = req.get_param_value("root_id");
+
+                const auto subtree = service_.ls_subtree(root_id, depth, max_nodes);
+                if (!subtree) {
+                    json j = {{"error", "task not found"}};
+                    return set_json(res, 404, j.dump());
+                }
+
+                std::string out = "{\"root_id\":";
+                task_json::append_string(out, root_id);
+                out += ",\"depth\":" + std::to_string(depth);
+                out += ",\"node_count\":" + std::to_string(subtree->node_count);
+                out += subtree->truncated ? ",\"truncated\":true" : ",\"truncated\":false";
+                out += ",\"children\":";
+                append_subtree(out, subtree->children);
+                out.push_back('}');
+
+                res.status = 200;
+                res.set_content(std::move(out), "application/json");
             } catch (const std::exception& e) {
                 json j = {{"error", e.what()}};
                 return set_json(res, 500, j.dump());
@@ -90,22 +686,19 @@ void HttpServer::register_api_endpoint() {
                 const std::string description =
                     body.value("description", std::string{""});
 
-                const TaskStatus status =
-                    body.contains("status") && body["status"].is_number_integer()
-                        ? static_cast<TaskStatus>(body["status"].get<int>())
-                        : TaskStatus::TODO;
-
-                const TaskPriority priority =
-                    body.contains("priority") && body["priority"].is_number_integer()
-                        ? static_cast<TaskPriority>(body["priority"].get<int>())
-                        : TaskPriority::MEDIUM;
+                std::optional<TaskStatus> status;
+                std::optional<TaskPriority> priority;
+                if (std::string error = parse_enum_fields(body, status, priority);
+                    !error.empty()) {
+                    return set_json(res, 400, json{{"error", error}}.dump());
+                }
 
                 TaskNode::Ptr created = service_.create_with_parent_id(
                     parent_id,
                     title,
                     description,
-                    status,
-                    priority
+                    status.value_or(TaskStatus::TODO),
+                    priority.value_or(TaskPriority::MEDIUM)
                 );
 
                 json out = {
@@ -129,6 +722,59 @@ void HttpServer::register_api_endpoint() {
         }
     );
 
+    // POST /api/batch/create
+    // Body:
+    // { "parent_id": "ROOT", "tasks": [
+    //     { "title": "Engine", "priority": 2, "children": [ { "title": "Renderer" } ] },
+    //     { "title": "Docs" } ] }
+    server_.Post("/api/batch/create",
+        [this](const httplib::Request& req, httplib::Response& res) {
+            try {
+                json body;
+                try {
+                    body = json::parse(req.body);
+                } catch (...) {
+                    json j = {{"error", "invalid JSON body"}};
+                    return set_json(res, 400, j.dump());
+                }
+
+                if (!body.contains("parent_id") || !body["parent_id"].is_string()) {
+                    json j = {{"error", "missing/invalid field: parent_id"}};
+                    return set_json(res, 400, j.dump());
+                }
+
+                if (!body.contains("tasks")) {
+                    json j = {{"error", "missing/invalid field: tasks"}};
+                    return set_json(res, 400, j.dump());
+                }
+
+                std::vector<TaskDraft> drafts;
+                std::size_t count = 0;
+                const std::string error = parse_drafts(body["tasks"], 0, count, drafts);
+                if (!error.empty()) {
+                    json j = {{"error", error}};
+                    return set_json(res, count > kMaxBatchTasks ? 413 : 400, j.dump());
+                }
+
+                const auto created = service_.create_batch(
+                    body["parent_id"].get<std::string>(),
+                    drafts
+                );
+
+                json ids = json::array();
+                for (const auto& node : created) {
+                    ids.push_back(node->get_id());
+                }
+
+                json out = {{"count", created.size()}, {"ids", ids}};
+                return set_json(res, 201, out.dump());
+            } catch (const std::exception& e) {
+                json j = {{"error", e.what()}};
+                return set_json(res, 500, j.dump());
+            }
+        }
+    );
+
         server_.Patch(
     "/api/modify",
     [this](const httplib::Request& req, httplib::Response& res) {
@@ -162,11 +808,9 @@ void HttpServer::register_api_endpoint() {
         if (body.contains("description") && body["description"].is_string())
             description = body["description"].get<std::string>();
 
-        if (body.contains("status") && body["status"].is_number_integer())
-            status = static_cast<TaskStatus>(body["status"].get<int>());
-
-        if (body.contains("priority") && body["priority"].is_number_integer())
-            priority = static_cast<TaskPriority>(body["priority"].get<int>());
+        if (std::string error = parse_enum_fields(body, status, priority); !error.empty()) {
+            return set_json(res, 400, json{{"error", error}}.dump());
+        }
 
         const bool ok = service_.modify(
             id,
@@ -248,22 +892,146 @@ void HttpServer::register_api_endpoint() {
 
 void HttpServer::setup_routes() {
     register_health_endpoint();
+    register_metrics_endpoint();
     register_api_endpoint();
+    register_route_table();
+}
+
+void HttpServer::register_route_table() {
+    const auto make = [](std::string_view method, std::string_view route) {
+        RouteMetrics m;
+        for (std::size_t i = 0; i < m.responses.size(); ++i) {
+            const std::string code = std::to_string(i + 1) + "xx";
+            m.responses[i] = &metrics::registry().counter(
+                "taskfarmer_http_requests_total",
+                "HTTP requests served, by route and status class.",
+                metrics::labels({{"method", method}, {"route", route}, {"code", code}}));
+        }
+        m.duration = &metrics::registry().histogram(
+            "taskfarmer_http_request_duration_seconds",
+            "Time from routing a request to its response being logged.",
+            metrics::labels({{"method", method}, {"route", route}}));
+        return m;
+    };
+
+    route_metrics_.clear();
+    for (const auto& [method, path, route_class] : kRoutes) {
+        std::string key = std::string(method) + " " + path;
+        admission_.add_route(key, route_class);
+        route_metrics_.emplace(std::move(key), make(method, path));
+    }
+    other_route_ = make("other", "other");
+}
+
+void HttpServer::record_request(const httplib::Request& req,
+                                const httplib::Response& res,
+                                std::chrono::steady_clock::duration elapsed) {
+    const auto it = route_metrics_.find(route_key(req));
+    const RouteMetrics& m = it != route_metrics_.end() ? it->second : other_route_;
+
+    const int status_class = std::clamp(res.status / 100, 1, 5);
+    m.responses[static_cast<std::size_t>(status_class - 1)]->add();
+    m.duration->observe(elapsed);
 }
 
 void HttpServer::run() {
     setup_routes();
 
-    server_.set_logger([](
+    server_.new_task_queue = [this] {
+        return new WorkerPool(config_.worker_threads, config_.max_queued, [] {
+            admission_ticket.reset();
+            request_started = {};
+        });
+    };
+    server_.set_keep_alive_max_count(config_.keep_alive_max_count);
+    server_.set_keep_alive_timeout(config_.keep_alive_timeout.count());
+    server_.set_read_timeout(config_.read_timeout.count());
+    server_.set_write_timeout(config_.write_timeout.count());
+    server_.set_payload_max_length(config_.payload_max_bytes);
+
+    server_.set_pre_routing_handler([this](const httplib::Request& req, httplib::Response& res) {
+        request_started = std::chrono::steady_clock::now();
+        // In case the logger did not run for this worker's last request.
+        admission_ticket.reset();
+
+        const auto queued = WorkerPool::take_queue_wait();
+
+        if (WorkerPool::take_shed_flag()) {
+            res.set_header("Retry-After", "1");
+            res.set_header("Connection", "close");
+            json j = {{"error", "server overloaded"}};
+            set_json(res, 503, j.dump());
+            return httplib::Server::HandlerResponse::Handled;
+        }
+
+        if (config_.admission.enabled) {
+            switch (admission_.admit(route_key(req), queued, admission_ticket)) {
+                case AdmissionController::Outcome::ADMITTED:
+                    break;
+                case AdmissionController::Outcome::QUEUE_FULL: {
+                    res.set_header("Retry-After", "1");
+                    json j = {{"error", "too many requests waiting for this route"}};
+                    set_json(res, 429, j.dump());
+                    return httplib::Server::HandlerResponse::Handled;
+                }
+                case AdmissionController::Outcome::TIMED_OUT: {
+                    res.set_header("Retry-After", "1");
+                    json j = {{"error", "server busy, request not started in time"}};
+                    set_json(res, 503, j.dump());
+                    return httplib::Server::HandlerResponse::Handled;
+                }
+            }
+        }
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
+
+    // httplib has already set Content-Length for the body by now, so it is
+    // replaced along with the body. Range responses are left alone.
+    server_.set_post_routing_handler([this](const httplib::Request& req, httplib::Response& res) {
+        if (res.status == 206 || req.has_header("Range") ||
+            !negotiated(config_.compression, res, res.get_header_value("Content-Type"))) {
+            return;
+        }
+        vary_on_accept_encoding(res);
+        if (res.body.size() < config_.compression.min_bytes) {
+            return;
+        }
+        const auto encoding = response_encoding(req);
+        if (encoding == compression::ContentEncoding::IDENTITY) {
+            return;
+        }
+
+        res.body = compression::compress(encoding, config_.compression, res.body);
+        res.headers.erase("Content-Length");
+        res.set_header("Content-Length", std::to_string(res.body.size()));
+        set_content_encoding(res, encoding);
+    });
+
+    server_.set_logger([this](
         const httplib::Request& req,
         const httplib::Response& res
     ) {
-        fprintf(stdout, "%s %s -> %d\n", req.method.c_str(),
-            req.path.c_str(), res.status
-        );
+        admission_ticket.reset();
+
+        // Requests rejected before routing (e.g. malformed) never started
+        // the clock; they are logged with a zero duration.
+        std::chrono::steady_clock::duration elapsed{};
+        if (request_started != std::chrono::steady_clock::time_point{}) {
+            elapsed = std::chrono::steady_clock::now() - request_started;
+            request_started = {};
+        }
+
+        record_request(req, res, elapsed);
+        access_log_.record(req.method, req.path, res.status, elapsed,
+                           res.body.size(), req.remote_addr);
     });
 
-    server_.listen(host_.c_str(), port_);
+    if (!server_.listen(config_.host, config_.port)) {
+        throw std::runtime_error(
+            "[ERROR] HttpServer: cannot listen on " + config_.host + ":" +
+            std::to_string(config_.port) + "."
+        );
+    }
 }
 
 void HttpServer::register_health_endpoint() {
@@ -285,4 +1053,113 @@ void HttpServer::register_health_endpoint() {
         res.set_content("echo: " + msg + "\n", "text/plain");
         res.status = 200;
     });
-}
\ No newline at end of file
+}
+
+void HttpServer::register_metrics_endpoint() {
+    // GET /metrics
+    // Prometheus text format: the recorded counters and histograms, then
+    // values sampled from the service now.
+    server_.Get("/metrics", [this](const httplib::Request&, httplib::Response& res) {
+        try {
+            std::string out;
+            out.reserve(64 * 1024);
+            metrics::registry().render(out);
+
+            metrics::append_gauge(out, "taskfarmer_http_worker_threads",
+                "Configured HTTP worker threads.",
+                static_cast<double>(config_.worker_threads));
+            metrics::append_gauge(out, "taskfarmer_http_max_queued",
+                "Configured connection queue depth before shedding (0 = unbounded).",
+                static_cast<double>(config_.max_queued));
+            metrics::append_gauge(out, "taskfarmer_http_keep_alive_max_count",
+                "Configured requests per kept-alive connection.",
+                static_cast<double>(config_.keep_alive_max_count));
+            metrics::append_gauge(out, "taskfarmer_http_keep_alive_timeout_seconds",
+                "Configured idle timeout of kept-alive connections.",
+                static_cast<double>(config_.keep_alive_timeout.count()));
+            metrics::append_gauge(out, "taskfarmer_http_read_timeout_seconds",
+                "Configured socket read timeout.",
+                static_cast<double>(config_.read_timeout.count()));
+            metrics::append_gauge(out, "taskfarmer_http_write_timeout_seconds",
+                "Configured socket write timeout.",
+                static_cast<double>(config_.write_timeout.count()));
+            metrics::append_gauge(out, "taskfarmer_http_payload_max_bytes",
+                "Configured largest accepted request body.",
+                static_cast<double>(config_.payload_max_bytes));
+            metrics::append_gauge(out, "taskfarmer_admission_enabled",
+                "Whether admission control gates the API routes.",
+                config_.admission.enabled ? 1.0 : 0.0);
+            metrics::append_gauge(out, "taskfarmer_admission_read_budget_seconds",
+                "Configured queue-time budget of read routes.",
+                static_cast<double>(config_.admission.read_budget.count()) / 1e3);
+            metrics::append_gauge(out, "taskfarmer_admission_write_budget_seconds",
+                "Configured queue-time budget of write routes.",
+                static_cast<double>(config_.admission.write_budget.count()) / 1e3);
+            metrics::append_gauge(out, "taskfarmer_admission_write_waiting",
+                "Configured writes that may wait for a slot (0 = half the write workers).",
+                static_cast<double>(config_.admission.write_waiting));
+            metrics::append_gauge(out, "taskfarmer_admission_bulk_concurrency",
+                "Configured concurrent bulk requests.",
+                static_cast<double>(config_.admission.bulk_concurrency));
+            metrics::append_gauge(out, "taskfarmer_http_compression_enabled",
+                "Whether JSON and text responses are compressed.",
+                config_.compression.enabled ? 1.0 : 0.0);
+            metrics::append_gauge(out, "taskfarmer_http_compression_min_bytes",
+                "Configured smallest response body that is compressed.",
+                static_cast<double>(config_.compression.min_bytes));
+            metrics::append_gauge(out, "taskfarmer_access_log_sample_rate",
+                "Configured fraction of requests written to the access log.",
+                config_.access_log.sample_rate);
+
+            const TaskService::TreeStats tree = service_.tree_stats();
+            metrics::append_gauge(out, "taskfarmer_tasks",
+                "Tasks in the in-memory tree, including ROOT.",
+                static_cast<double>(tree.tasks));
+            metrics::append_gauge(out, "taskfarmer_tree_memory_bytes_estimate",
+                "Estimated memory held by the in-memory tree and its indexes.",
+                static_cast<double>(tree.estimated_bytes));
+            metrics::append_gauge(out, "taskfarmer_sqlite_memory_used_bytes",
+                "Memory currently allocated by SQLite.",
+                static_cast<double>(sqlite3_memory_used()));
+
+            const WriteJournal::Stats journal = service_.journal_stats();
+            metrics::append_gauge(out, "taskfarmer_journal_depth",
+                "Writes queued for the database.", static_cast<double>(journal.depth));
+            metrics::append_gauge(out, "taskfarmer_journal_capacity",
+                "Capacity of the write queue.", static_cast<double>(journal.capacity));
+            metrics::append_counter(out, "taskfarmer_journal_submitted_total",
+                "Writes submitted to the journal.", static_cast<double>(journal.submitted));
+            metrics::append_counter(out, "taskfarmer_journal_failed_total",
+                "Writes that failed to reach the database.", static_cast<double>(journal.failed));
+            metrics::append_counter(out, "taskfarmer_journal_blocked_submits_total",
+                "Submits that waited for room in the queue.",
+                static_cast<double>(journal.blocked_submits));
+            metrics::append_counter(out, "taskfarmer_journal_batches_total",
+                "Transactions committed by the journal.", static_cast<double>(journal.batches));
+
+            const StatementCache::Stats statements = service_.statement_cache_stats();
+            metrics::append_counter(out, "taskfarmer_statement_cache_hits_total",
+                "Prepared-statement cache hits on the writer connection.",
+                static_cast<double>(statements.hits));
+            metrics::append_counter(out, "taskfarmer_statement_cache_misses_total",
+                "Prepared-statement cache misses on the writer connection.",
+                static_cast<double>(statements.misses));
+
+            if (const auto pool = service_.read_pool_stats()) {
+                metrics::append_gauge(out, "taskfarmer_read_pool_in_use",
+                    "Read connections currently lent out.", static_cast<double>(pool->in_use));
+                metrics::append_gauge(out, "taskfarmer_read_pool_size",
+                    "Read connections in the pool.", static_cast<double>(pool->size));
+                metrics::append_counter(out, "taskfarmer_read_pool_wait_seconds_total",
+                    "Total time acquires waited for a free read connection.",
+                    static_cast<double>(pool->wait_ns) / 1e9);
+            }
+
+            res.status = 200;
+            res.set_content(std::move(out), "text/plain; version=0.0.4");
+        } catch (const std::exception& e) {
+            json j = {{"error", e.what()}};
+            return set_json(res, 500, j.dump());
+        }
+    });
+}
@@ -0,0 +1,236 @@
+#include "../include/Metrics.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace metrics {
+
+namespace {
+
+void append_number(std::string& out, double value) {
+    char buf[32];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+void append_number(std::string& out, std::uint64_t value) {
+    char buf[24];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+void append_header(std::string& out, std::string_view name, std::string_view help,
+                   std::string_view type) {
+    out += "# HELP ";
+    out += name;
+    out.push_back(' ');
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out.push_back(' ');
+    out += type;
+    out.push_back('\n');
+}
+
+// `label_set` with one more label added, e.g. {route="/x"} + le="0.5".
+std::string with_label(std::string_view label_set, std::string_view key, std::string_view value) {
+    std::string out;
+    if (label_set.empty()) {
+        out = "{";
+    } else {
+        out.assign(label_set.substr(0, label_set.size() - 1));
+        out.push_back(',');
+    }
+    out += key;
+    out += "=\"";
+    out += value;
+    out += "\"}";
+    return out;
+}
+
+void append_sample(std::string& out, std::string_view name, std::string_view help,
+                   std::string_view type, double value, std::string_view label_set) {
+    append_header(out, name, help, type);
+    out += name;
+    out += label_set;
+    out.push_back(' ');
+    append_number(out, value);
+    out.push_back('\n');
+}
+
+} // namespace
+
+std::size_t shard_index() {
+    static std::atomic<std::size_t> next{0};
+    static thread_local const std::size_t index =
+        next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return index;
+}
+
+std::uint64_t Counter::value() const {
+    std::uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Histogram::observe_ns(std::uint64_t ns) {
+    const auto bucket = static_cast<std::size_t>(
+        std::lower_bound(kBoundsNs.begin(), kBoundsNs.end(), ns) - kBoundsNs.begin());
+
+    Shard& shard = shards_[shard_index()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum_ns.fetch_add(ns, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    for (const auto& shard : shards_) {
+        for (std::size_t i = 0; i < shard.buckets.size(); ++i) {
+            const std::uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += n;
+            snapshot.count += n;
+        }
+        snapshot.sum_ns += shard.sum_ns.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+std::string labels(std::initializer_list<std::pair<std::string_view, std::string_view>> pairs) {
+    std::string out = "{";
+    for (const auto& [key, value] : pairs) {
+        if (out.size() > 1) {
+            out.push_back(',');
+        }
+        out += key;
+        out += "=\"";
+        for (const char c : value) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '"':  out += "\\\""; break;
+                case '\n': out += "\\n"; break;
+                default:   out.push_back(c);
+            }
+        }
+        out.push_back('"');
+    }
+    out.push_back('}');
+    return out;
+}
+
+void append_gauge(std::string& out, std::string_view name, std::string_view help,
+                  double value, std::string_view label_set) {
+    append_sample(out, name, help, "gauge", value, label_set);
+}
+
+void append_counter(std::string& out, std::string_view name, std::string_view help,
+                    double value, std::string_view label_set) {
+    append_sample(out, name, help, "counter", value, label_set);
+}
+
+template <typename Metric>
+Metric& Registry::get_or_create(Families<Metric>& families, std::string_view name,
+                                std::string_view help, std::string_view label_set) {
+    auto family = families.find(name);
+    if (family == families.end()) {
+        family = families.emplace(std::string(name), Family<Metric>{std::string(help), {}}).first;
+    }
+
+    auto& series = family->second.series;
+    auto it = series.find(label_set);
+    if (it == series.end()) {
+        it = series.emplace(std::string(label_set), std::make_unique<Metric>()).first;
+    }
+    return *it->second;
+}
+
+Counter& Registry::counter(std::string_view name, std::string_view help,
+                           std::string_view label_set) {
+    std::lock_guard lock(mutex_);
+    return get_or_create(counters_, name, help, label_set);
+}
+
+Gauge& Registry::gauge(std::string_view name, std::string_view help,
+                       std::string_view label_set) {
+    std::lock_guard lock(mutex_);
+    return get_or_create(gauges_, name, help, label_set);
+}
+
+Histogram& Registry::histogram(std::string_view name, std::string_view help,
+                               std::string_view label_set) {
+    std::lock_guard lock(mutex_);
+    return get_or_create(histograms_, name, help, label_set);
+}
+
+void Registry::render(std::string& out) const {
+    std::lock_guard lock(mutex_);
+
+    for (const auto& [name, family] : counters_) {
+        append_header(out, name, family.help, "counter");
+        for (const auto& [label_set, counter] : family.series) {
+            out += name;
+            out += label_set;
+            out.push_back(' ');
+            append_number(out, counter->value());
+            out.push_back('\n');
+        }
+    }
+
+    for (const auto& [name, family] : gauges_) {
+        append_header(out, name, family.help, "gauge");
+        for (const auto& [label_set, gauge] : family.series) {
+            out += name;
+            out += label_set;
+            out.push_back(' ');
+            append_number(out, static_cast<double>(gauge->value()));
+            out.push_back('\n');
+        }
+    }
+
+    for (const auto& [name, family] : histograms_) {
+        append_header(out, name, family.help, "histogram");
+        for (const auto& [label_set, histogram] : family.series) {
+            const Histogram::Snapshot snapshot = histogram->snapshot();
+
+            std::uint64_t cumulative = 0;
+            for (std::size_t i = 0; i <= Histogram::kBuckets; ++i) {
+                cumulative += snapshot.buckets[i];
+
+                std::string le = "+Inf";
+                if (i < Histogram::kBuckets) {
+                    le.clear();
+                    append_number(le, static_cast<double>(Histogram::kBoundsNs[i]) / 1e9);
+                }
+
+                out += name;
+                out += "_bucket";
+                out += with_label(label_set, "le", le);
+                out.push_back(' ');
+                append_number(out, cumulative);
+                out.push_back('\n');
+            }
+
+            out += name;
+            out += "_sum";
+            out += label_set;
+            out.push_back(' ');
+            append_number(out, static_cast<double>(snapshot.sum_ns) / 1e9);
+            out.push_back('\n');
+
+            out += name;
+            out += "_count";
+            out += label_set;
+            out.push_back(' ');
+            append_number(out, snapshot.count);
+            out.push_back('\n');
+        }
+    }
+}
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+} // namespace metrics
@@ -0,0 +1,81 @@
+#include "../include/ReadConnectionPool.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+ReadConnectionPool::ReadConnectionPool(std::string db_path, std::size_t size) {
+    if (size == 0) {
+        throw std::runtime_error("[ERROR] ReadConnectionPool: size must be positive.");
+    }
+    if (!shareable(db_path)) {
+        throw std::runtime_error(
+            "[ERROR] ReadConnectionPool: database cannot be opened by other connections."
+        );
+    }
+
+    connections_.reserve(size);
+    idle_.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        connections_.push_back(std::make_unique<Database>(db_path, DatabaseAccess::READ_ONLY));
+        idle_.push_back(connections_.back().get());
+    }
+    stats_.size = size;
+}
+
+bool ReadConnectionPool::shareable(std::string_view db_path) {
+    return !db_path.empty() &&
+           db_path != ":memory:" &&
+           db_path.find("mode=memory") == std::string_view::npos;
+}
+
+ReadConnectionPool::Lease ReadConnectionPool::acquire() {
+    Database* db = nullptr;
+    {
+        std::unique_lock lock(mutex_);
+        if (idle_.empty()) {
+            const auto start = std::chrono::steady_clock::now();
+            available_.wait(lock, [this] { return !idle_.empty(); });
+            ++stats_.waits;
+            stats_.wait_ns += static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+        }
+        db = idle_.back();
+        idle_.pop_back();
+        ++stats_.in_use;
+        ++stats_.acquired;
+    }
+
+    // Opened outside mutex_ so a slow first open does not hold up others.
+    try {
+        db->open();
+    } catch (...) {
+        release(db);
+        throw;
+    }
+    return Lease(this, db);
+}
+
+void ReadConnectionPool::release(Database* db) {
+    {
+        std::lock_guard lock(mutex_);
+        idle_.push_back(db);
+        --stats_.in_use;
+    }
+    available_.notify_one();
+}
+
+ReadConnectionPool::Stats ReadConnectionPool::stats() const {
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+ReadConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(std::exchange(other.pool_, nullptr)), db_(std::exchange(other.db_, nullptr)) {}
+
+ReadConnectionPool::Lease::~Lease() {
+    if (pool_) {
+        pool_->release(db_);
+    }
+}
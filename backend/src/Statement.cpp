@@ -0,0 +1,202 @@
+// Statement.cpp
+#include "../include/Statement.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+metrics::Histogram& statement_timing(std::string_view context) {
+    return metrics::registry().histogram(
+        "taskfarmer_sqlite_statement_duration_seconds",
+        "Time from first step to reset of a SQLite statement, by call site.",
+        metrics::labels({{"statement", context}}));
+}
+
+} // namespace
+
+Statement::Statement(sqlite3* db,
+                     sqlite3_stmt* stmt,
+                     StatementCache* owner,
+                     CachedStatement* entry,
+                     std::string_view context,
+                     metrics::Histogram* timing)
+    : db_(db), stmt_(stmt), owner_(owner), entry_(entry), context_(context), timing_(timing) {}
+
+Statement::Statement(Statement&& other) noexcept
+    : db_(other.db_),
+      stmt_(std::exchange(other.stmt_, nullptr)),
+      owner_(other.owner_),
+      entry_(other.entry_),
+      context_(other.context_),
+      timing_(other.timing_),
+      started_(other.started_) {}
+
+Statement::~Statement() {
+    if (stmt_ == nullptr) {
+        return;
+    }
+
+    if (timing_ != nullptr && started_ != std::chrono::steady_clock::time_point{}) {
+        timing_->observe(std::chrono::steady_clock::now() - started_);
+    }
+
+    if (owner_ != nullptr) {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+        owner_->release(entry_);
+    } else {
+        sqlite3_finalize(stmt_);
+    }
+}
+
+void Statement::check(int rc, std::string_view what) const {
+    if (rc == SQLITE_OK || rc == SQLITE_ROW || rc == SQLITE_DONE) {
+        return;
+    }
+
+    const char* err = db_ ? sqlite3_errmsg(db_) : "sqlite error";
+    throw std::runtime_error(
+        std::string(context_) + ": " + std::string(what) + ": " + err
+    );
+}
+
+void Statement::bind_text(int index, std::string_view value) {
+    check(
+        sqlite3_bind_text(
+            stmt_,
+            index,
+            value.data(),
+            static_cast<int>(value.size()),
+            SQLITE_TRANSIENT
+        ),
+        "bind"
+    );
+}
+
+void Statement::bind_int(int index, int value) {
+    check(sqlite3_bind_int(stmt_, index, value), "bind");
+}
+
+void Statement::bind_int64(int index, sqlite3_int64 value) {
+    check(sqlite3_bind_int64(stmt_, index, value), "bind");
+}
+
+void Statement::bind_null(int index) {
+    check(sqlite3_bind_null(stmt_, index), "bind");
+}
+
+void Statement::start_timing() {
+    if (started_ == std::chrono::steady_clock::time_point{}) {
+        started_ = std::chrono::steady_clock::now();
+    }
+}
+
+bool Statement::step() {
+    start_timing();
+    const int rc = sqlite3_step(stmt_);
+    check(rc, "step");
+    return rc == SQLITE_ROW;
+}
+
+void Statement::run() {
+    start_timing();
+    const int rc = sqlite3_step(stmt_);
+    if (rc == SQLITE_ROW) {
+        throw std::runtime_error(
+            std::string(context_) + ": step: statement returned a row"
+        );
+    }
+    check(rc, "step");
+}
+
+StatementCache::~StatementCache() { clear(); }
+
+Statement StatementCache::acquire(sqlite3* db,
+                                  std::string_view sql,
+                                  std::string_view context) {
+    if (db == nullptr) {
+        throw std::runtime_error(
+            std::string(context) + ": database is uninitialised"
+        );
+    }
+
+    std::unique_lock lock(mutex_);
+
+    auto it = entries_.find(sql);
+    if (it != entries_.end() && !it->second.in_use) {
+        ++hits_;
+        it->second.in_use = true;
+        return Statement(db, it->second.stmt, this, &it->second, context, it->second.timing);
+    }
+
+    ++misses_;
+    const bool cache_it = it == entries_.end();
+    lock.unlock();
+
+    sqlite3_stmt* stmt = nullptr;
+    const int rc = sqlite3_prepare_v2(
+        db,
+        sql.data(),
+        static_cast<int>(sql.size()),
+        &stmt,
+        nullptr
+    );
+    if (rc != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        throw std::runtime_error(
+            std::string(context) + ": prepare: " + sqlite3_errmsg(db)
+        );
+    }
+
+    metrics::Histogram* timing = &statement_timing(context);
+
+    if (!cache_it) {
+        // The cached copy is borrowed; hand out a one-off statement.
+        return Statement(db, stmt, nullptr, nullptr, context, timing);
+    }
+
+    lock.lock();
+    const auto [inserted, ok] =
+        entries_.try_emplace(std::string(sql), CachedStatement{stmt, true, false, timing});
+    if (!ok) {
+        // Another thread cached the same query while we were preparing.
+        return Statement(db, stmt, nullptr, nullptr, context, timing);
+    }
+    return Statement(db, stmt, this, &inserted->second, context, timing);
+}
+
+void StatementCache::release(CachedStatement* entry) {
+    std::lock_guard lock(mutex_);
+    entry->in_use = false;
+
+    if (entry->retired) {
+        // clear() ran while this statement was borrowed.
+        sqlite3_finalize(entry->stmt);
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (&it->second == entry) {
+                entries_.erase(it);
+                break;
+            }
+        }
+    }
+}
+
+void StatementCache::clear() {
+    std::lock_guard lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.in_use) {
+            // Finalized by release() once its guard goes away.
+            it->second.retired = true;
+            ++it;
+            continue;
+        }
+        sqlite3_finalize(it->second.stmt);
+        it = entries_.erase(it);
+    }
+}
+
+StatementCache::Stats StatementCache::stats() const {
+    std::lock_guard lock(mutex_);
+    return Stats{hits_, misses_, entries_.size()};
+}
@@ -0,0 +1,97 @@
+#include "../include/TaskId.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace {
+
+// splitmix64: one add and a mix per id. Each thread seeds its own state
+// from random_device, the clock and its thread id, so threads started at
+// the same instant still draw different sequences.
+std::uint64_t next_random() {
+    static thread_local std::uint64_t state = [] {
+        std::random_device device;
+        const std::uint64_t entropy =
+            (static_cast<std::uint64_t>(device()) << 32) ^ device();
+        const auto now = static_cast<std::uint64_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+        const auto thread = static_cast<std::uint64_t>(
+            std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        return task_id::mix(entropy ^ task_id::mix(now ^ task_id::mix(thread)));
+    }();
+
+    state += 0x9e3779b97f4a7c15ULL;
+    return task_id::mix(state);
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+TaskId TaskId::generate() {
+    return TaskId(next_random());
+}
+
+TaskId TaskId::generate_ordered() {
+    static constexpr unsigned kSequenceBits = 64 - kTagBits - kTimeBits;
+    static constexpr std::uint64_t kTag = ~std::uint64_t{0} << (64 - kTagBits);
+    static std::atomic<std::uint64_t> last{0};
+
+    const auto now_ms = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+    // The random start leaves half the sequence space for ids minted later
+    // in the same millisecond; past that they borrow from the next one.
+    const std::uint64_t start = next_random() & ((1ULL << (kSequenceBits - 1)) - 1);
+    const std::uint64_t candidate = kTag | now_ms << kSequenceBits | start;
+
+    std::uint64_t prev = last.load(std::memory_order_relaxed);
+    std::uint64_t next;
+    do {
+        next = candidate > prev ? candidate : prev + 1;
+    } while (!last.compare_exchange_weak(prev, next, std::memory_order_relaxed));
+
+    return TaskId(next);
+}
+
+std::optional<TaskId> TaskId::from_hex(std::string_view hex) {
+    if (hex.size() != kHexLength) {
+        return std::nullopt;
+    }
+
+    std::uint64_t value = 0;
+    for (const char c : hex) {
+        const int digit = hex_value(c);
+        if (digit < 0) {
+            return std::nullopt;
+        }
+        value = value << 4 | static_cast<std::uint64_t>(digit);
+    }
+    return TaskId(value);
+}
+
+std::string TaskId::to_hex() const {
+    std::string out;
+    append_hex(out);
+    return out;
+}
+
+void TaskId::append_hex(std::string& out) const {
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    char buf[kHexLength];
+    std::uint64_t value = value_;
+    for (std::size_t i = kHexLength; i-- > 0;) {
+        buf[i] = kHex[value & 0xF];
+        value >>= 4;
+    }
+    out.append(buf, kHexLength);
+}
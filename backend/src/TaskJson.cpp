@@ -0,0 +1,192 @@
+#include "../include/TaskJson.hpp"
+
+#include <array>
+#include <charconv>
+
+namespace {
+
+template <typename Number>
+void append_number(std::string& out, Number value) {
+    char buf[32];
+    const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+template <typename Int, std::size_t N>
+void append_int_array(std::string& out, const std::array<Int, N>& values) {
+    out.push_back('[');
+    for (std::size_t i = 0; i < N; ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        append_number(out, values[i]);
+    }
+    out.push_back(']');
+}
+
+// Length of the well-formed UTF-8 sequence starting at value[i] (whose
+// lead byte is >= 0x80), or 0 if it is not one: stray continuation bytes,
+// overlong forms, surrogates, code points above U+10FFFF and truncated
+// sequences are all rejected.
+std::size_t utf8_sequence_length(std::string_view value, std::size_t i) {
+    const auto byte = [&](std::size_t k) {
+        return static_cast<unsigned char>(value[i + k]);
+    };
+    const unsigned char lead = byte(0);
+
+    std::size_t length = 0;
+    unsigned char low = 0x80;   // allowed range of the second byte
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return 0;
+    }
+
+    if (value.size() - i < length || byte(1) < low || byte(1) > high) {
+        return 0;
+    }
+    for (std::size_t k = 2; k < length; ++k) {
+        if (byte(k) < 0x80 || byte(k) > 0xBF) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+} // namespace
+
+namespace task_json {
+
+void append_string(std::string& out, std::string_view value) {
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    out.push_back('"');
+
+    std::size_t run = 0;  // start of the pending run of unescaped bytes
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        const auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x80) {
+            // Valid UTF-8 is copied as is. Each byte of anything else
+            // becomes U+FFFD, as the DOM's dump() with the replace error
+            // handler would write, rather than ending up in the output.
+            if (const std::size_t length = utf8_sequence_length(value, i)) {
+                i += length - 1;
+                continue;
+            }
+            out.append(value.data() + run, i - run);
+            run = i + 1;
+            out += "\xEF\xBF\xBD";
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        out.append(value.data() + run, i - run);
+        run = i + 1;
+
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                const char escaped[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+                out.append(escaped, sizeof(escaped));
+            }
+        }
+    }
+    out.append(value.data() + run, value.size() - run);
+
+    out.push_back('"');
+}
+
+void append_task_fields(std::string& out, const TaskNode& task) {
+    out += "\"id\":";
+    append_string(out, task.get_id());
+    out += ",\"title\":";
+    append_string(out, task.get_title());
+    out += ",\"description\":";
+    append_string(out, task.get_description());
+    out += ",\"status\":";
+    append_number(out, static_cast<int>(task.get_status()));
+    out += ",\"priority\":";
+    append_number(out, static_cast<int>(task.get_priority()));
+    out += ",\"created_at\":";
+    append_number(out, static_cast<long long>(task.get_created_at()));
+    out += ",\"last_updated_at\":";
+    append_number(out, static_cast<long long>(task.get_updated_at()));
+}
+
+void append_rollup(std::string& out, const TaskNode& task) {
+    const TaskNode::Rollup& rollup = task.get_rollup();
+
+    out += "\"rollup\":{\"descendants\":";
+    append_number(out, rollup.descendants);
+    out += ",\"by_status\":";
+    append_int_array(out, rollup.by_status);
+    out += ",\"by_priority\":";
+    append_int_array(out, rollup.by_priority);
+    out += ",\"max_priority\":";
+    if (const auto max = rollup.max_priority()) {
+        append_number(out, static_cast<int>(*max));
+    } else {
+        out += "null";
+    }
+    out += ",\"completion_percent\":";
+    append_number(out, rollup.completion_percent());
+    out.push_back('}');
+}
+
+void append_task(std::string& out, const TaskNode& task) {
+    out.push_back('{');
+    append_task_fields(out, task);
+    out.push_back(',');
+    append_rollup(out, task);
+    out.push_back('}');
+}
+
+} // namespace task_json
+
+TaskListingStream::TaskListingStream(std::vector<TaskNode::Ptr> tasks,
+                                     std::size_t chunk_bytes)
+    : tasks_(std::move(tasks)), chunk_bytes_(chunk_bytes) {}
+
+bool TaskListingStream::next(std::string& chunk) {
+    chunk.clear();
+    if (closed_) {
+        return false;
+    }
+
+    if (!opened_) {
+        chunk.push_back('[');
+        opened_ = true;
+    }
+
+    while (pos_ < tasks_.size() && chunk.size() < chunk_bytes_) {
+        if (pos_ > 0) {
+            chunk.push_back(',');
+        }
+        task_json::append_task(chunk, *tasks_[pos_]);
+        ++pos_;
+    }
+
+    if (pos_ == tasks_.size()) {
+        chunk.push_back(']');
+        closed_ = true;
+    }
+
+    return true;
+}
@@ -1,9 +1,9 @@
 // TaskNode.cpp
 #include "../include/TaskNode.hpp"
+#include "../include/TaskId.hpp"
 
 #include <algorithm>
-#include <random>
-#include <sstream>
+#include <cassert>
 #include <stdexcept>
 #include <utility>
 #include <vector>
@@ -11,31 +11,18 @@
 namespace {
 
 
-std::vector<std::string_view> split_path(std::string_view path) {
-    std::vector<std::string_view> parts;
-
+// Pops the next non-empty '/'-separated segment off the front of `path`.
+// Returns false once no segments are left.
+bool next_segment(std::string_view& path, std::string_view& segment) {
     while (!path.empty()) {
-        while (!path.empty() && path.front() == '/') {
-            path.remove_prefix(1);
-        }
-        if (path.empty()) {
-            break;
-        }
-
         const auto slash = path.find('/');
-        if (slash == std::string_view::npos) {
-            parts.push_back(path);
-            break;
+        segment = path.substr(0, slash);
+        path.remove_prefix(slash == std::string_view::npos ? path.size() : slash + 1);
+        if (!segment.empty()) {
+            return true;
         }
-
-        const auto seg = path.substr(0, slash);
-        if (!seg.empty()) {
-            parts.push_back(seg);
-        }
-        path.remove_prefix(slash + 1);
     }
-
-    return parts;
+    return false;
 }
 
 } 
@@ -67,6 +54,8 @@ TaskNode::TaskNode(
     if (id_.empty()) {
         throw std::invalid_argument("[ERROR] TaskNode hydration: id is empty");
     }
+    assert(is_valid_status(static_cast<long long>(status_)));
+    assert(is_valid_priority(static_cast<long long>(priority_)));
 }
 
 TaskNode::Ptr TaskNode::create_child(
@@ -82,14 +71,39 @@ TaskNode::Ptr TaskNode::create_child(
         std::make_shared<TaskNode>(std::move(title), std::move(description));
     child->parent_ = parent.get();
 
-    parent->children_.push_back(child);
+    parent->insert_ordered(child);
     parent->touch();
 
     return child;
 }
 
+TaskNode::Ptr TaskNode::clone_detached() const {
+    auto clone = std::make_shared<TaskNode>(
+        id_,
+        title_,
+        description_,
+        status_,
+        priority_,
+        created_at_,
+        updated_at_
+    );
+    clone->rollup_ = rollup_;
+    return clone;
+}
+
 void TaskNode::set_title(const std::string& title) {
+    // The parent's index is keyed by a view of title_, so the entry has to
+    // come out before the string changes.
+    Ptr self;
+    if (parent_ && parent_->title_index_) {
+        self = parent_->erase_title_entry(this);
+    }
+
     title_ = title;
+
+    if (self) {
+        parent_->title_index_->emplace(title_, std::move(self));
+    }
     touch();
 }
 
@@ -99,27 +113,144 @@ void TaskNode::set_description(const std::string& description) {
 }
 
 void TaskNode::set_status(TaskStatus status) {
+    assert(is_valid_status(static_cast<long long>(status)));
+    for (TaskNode* a = parent_; a; a = a->parent_) {
+        --a->rollup_.by_status[static_cast<std::size_t>(status_)];
+        ++a->rollup_.by_status[static_cast<std::size_t>(status)];
+    }
     status_ = status;
     touch();
 }
 
 void TaskNode::set_priority(TaskPriority priority) {
+    assert(is_valid_priority(static_cast<long long>(priority)));
+    for (TaskNode* a = parent_; a; a = a->parent_) {
+        --a->rollup_.by_priority[static_cast<std::size_t>(priority_)];
+        ++a->rollup_.by_priority[static_cast<std::size_t>(priority)];
+    }
     priority_ = priority;
     touch();
 }
 
+void TaskNode::apply_to_ancestors(const TaskNode& child, int sign) {
+    const Rollup& sub = child.rollup_;
+    const auto status = static_cast<std::size_t>(child.status_);
+    const auto priority = static_cast<std::size_t>(child.priority_);
+
+    for (TaskNode* a = this; a; a = a->parent_) {
+        Rollup& r = a->rollup_;
+        if (sign > 0) {
+            r.descendants += sub.descendants + 1;
+            ++r.by_status[status];
+            ++r.by_priority[priority];
+            for (std::size_t i = 0; i < 4; ++i) {
+                r.by_status[i] += sub.by_status[i];
+                r.by_priority[i] += sub.by_priority[i];
+            }
+        } else {
+            r.descendants -= sub.descendants + 1;
+            --r.by_status[status];
+            --r.by_priority[priority];
+            for (std::size_t i = 0; i < 4; ++i) {
+                r.by_status[i] -= sub.by_status[i];
+                r.by_priority[i] -= sub.by_priority[i];
+            }
+        }
+    }
+}
+
+std::optional<TaskPriority> TaskNode::Rollup::max_priority() const {
+    for (std::size_t i = by_priority.size(); i-- > 0;) {
+        if (by_priority[i] > 0) {
+            return static_cast<TaskPriority>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+double TaskNode::Rollup::completion_percent() const {
+    if (descendants == 0) {
+        return 0.0;
+    }
+    const auto done = by_status[static_cast<std::size_t>(TaskStatus::COMPLETED)];
+    return 100.0 * static_cast<double>(done) / static_cast<double>(descendants);
+}
+
 void TaskNode::add_child(const Ptr& child) {
+    link_child(child);
+    touch();
+}
+
+void TaskNode::link_child(const Ptr& child) {
     if (!child) {
         throw std::invalid_argument("TaskNode::add_child: child is null");
     }
 
     child->parent_ = this;
-    children_.push_back(child);
-    touch();
+    insert_ordered(child);
+}
+
+void TaskNode::insert_ordered(const Ptr& child) {
+    if (children_.empty() ||
+        ordered_before(children_.back(), child->created_at_, child->id_)) {
+        children_.push_back(child);
+    } else {
+        const auto pos = std::lower_bound(
+            children_.begin(), children_.end(), child,
+            [](const Ptr& a, const Ptr& b) {
+                return ordered_before(a, b->created_at_, b->id_);
+            });
+        children_.insert(pos, child);
+    }
+
+    apply_to_ancestors(*child, +1);
+
+    if (title_index_) {
+        title_index_->emplace(child->title_, child);
+    } else if (children_.size() >= kTitleIndexThreshold) {
+        build_title_index();
+    }
+}
+
+void TaskNode::build_title_index() {
+    title_index_ = std::make_unique<TitleIndex>();
+    title_index_->reserve(children_.size());
+    for (const auto& c : children_) {
+        if (c) {
+            title_index_->emplace(c->title_, c);
+        }
+    }
+}
+
+TaskNode::Ptr TaskNode::erase_title_entry(const TaskNode* child) {
+    auto [it, end] = title_index_->equal_range(std::string_view{child->title_});
+    for (; it != end; ++it) {
+        if (it->second.get() == child) {
+            Ptr owner = std::move(it->second);
+            title_index_->erase(it);
+            return owner;
+        }
+    }
+    return nullptr;
+}
+
+bool TaskNode::ordered_before(const Ptr& a, std::time_t created_at, std::string_view id) {
+    if (a->created_at_ != created_at) {
+        return a->created_at_ < created_at;
+    }
+    return a->id_ < id;
+}
+
+std::vector<TaskNode::Ptr>::const_iterator TaskNode::first_after(
+    const std::vector<Ptr>& listing, std::time_t created_at, std::string_view id) {
+    return std::partition_point(listing.begin(), listing.end(), [&](const Ptr& a) {
+        return a->created_at_ < created_at ||
+               (a->created_at_ == created_at && a->id_ <= id);
+    });
 }
 
 bool TaskNode::remove_child_by_id(const std::string& id) {
-    const auto it = std::remove_if(
+    const auto it = std::find_if(
         children_.begin(),
         children_.end(),
         [&](const Ptr& c) { return c && c->get_id() == id; }
@@ -129,13 +260,18 @@ bool TaskNode::remove_child_by_id(const std::string& id) {
         return false;
     }
 
-    for (auto jt = it; jt != children_.end(); ++jt) {
-        if (*jt) {
-            (*jt)->parent_ = nullptr;
-        }
+    // Unlinked while *it still holds the child; erase comes last.
+    const Ptr child = *it;
+    if (title_index_) {
+        erase_title_entry(child.get());
     }
+    apply_to_ancestors(*child, -1);
+    child->parent_ = nullptr;
 
-    children_.erase(it, children_.end());
+    children_.erase(it);
+    if (title_index_ && children_.size() < kTitleIndexThreshold / 2) {
+        title_index_.reset();
+    }
     touch();
     return true;
 }
@@ -150,9 +286,26 @@ TaskNode::Ptr TaskNode::find_child_by_id(const std::string& id) const {
 }
 
 TaskNode::Ptr TaskNode::find_child_by_title(std::string_view title) const {
+    const Ptr* child = find_child_slot(title);
+    return child ? *child : nullptr;
+}
+
+const TaskNode::Ptr* TaskNode::find_child_slot(std::string_view title) const {
+    if (title_index_) {
+        auto [it, end] = title_index_->equal_range(title);
+        const Ptr* first = nullptr;
+        for (; it != end; ++it) {
+            const Ptr& c = it->second;
+            if (!first || ordered_before(c, (*first)->created_at_, (*first)->id_)) {
+                first = &c;
+            }
+        }
+        return first;
+    }
+
     for (const auto& c : children_) {
         if (c && c->get_title() == title) {
-            return c;
+            return &c;
         }
     }
     return nullptr;
@@ -164,33 +317,29 @@ std::string TaskNode::get_path() const {
         return "/";
     }
 
-    std::string out;
-    const TaskNode* cur = this;
-
-    // Walk up using raw parent pointers; this is safe as long as nodes live
-    // for the lifetime of the tree (which they do via shared_ptr ownership).
-    while (cur && cur->parent_) {
-        out.insert(0, "/" + cur->title_);
-        cur = cur->parent_;
+    // Collect the titles bottom-up, then write them top-down into one
+    // pre-sized string (prepending each title was quadratic in depth).
+    std::vector<const std::string*> titles;
+    std::size_t length = 1;
+    for (const TaskNode* cur = this; cur && cur->parent_; cur = cur->parent_) {
+        titles.push_back(&cur->title_);
+        length += cur->title_.size() + 1;
     }
 
-    if (out.empty()) {
-        return "/";
+    std::string out;
+    out.reserve(length);
+    for (auto it = titles.rbegin(); it != titles.rend(); ++it) {
+        out += '/';
+        out += **it;
     }
-    return out + "/";
+    out += '/';
+    return out;
 }
 
 void TaskNode::touch() { updated_at_ = std::time(nullptr); }
 
 std::string TaskNode::generate_id() {
-    static thread_local std::mt19937 rng{std::random_device{}()};
-    static thread_local std::uniform_int_distribution<int> dist(0, 15);
-
-    std::ostringstream oss;
-    for (int i = 0; i < 16; ++i) {
-        oss << std::hex << dist(rng);
-    }
-    return oss.str();
+    return TaskId::generate_ordered().to_hex();
 }
 
 TaskNode::Ptr resolve_path(
@@ -205,14 +354,16 @@ TaskNode::Ptr resolve_path(
         return workspace_root;
     }
 
-    auto current = workspace_root;
-    for (const auto seg : split_path(absolute_path)) {
-        auto next = current->find_child_by_title(seg);
-        if (!next) {
+    // Walks with borrowed pointers; only the result is copied out.
+    const TaskNode::Ptr* current = &workspace_root;
+    std::string_view rest = absolute_path;
+    std::string_view segment;
+    while (next_segment(rest, segment)) {
+        current = (*current)->find_child_slot(segment);
+        if (!current) {
             return nullptr;
         }
-        current = next;
     }
 
-    return current;
+    return *current;
 }
\ No newline at end of file
@@ -1,33 +1,309 @@
 #include "../include/TaskService.hpp"
+#include "../include/Metrics.hpp"
 
-
-#include "../include/TaskService.hpp"
-
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <deque>
 #include <mutex>
 #include <shared_mutex>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
-TaskService::TaskService(Database& db) : db_(db) {
-    init();
+namespace {
+
+// std::shared_lock / std::unique_lock on mutex_ that records how long the
+// caller waited for the lock and how long it then held it, by mode.
+template <typename Lock>
+class TimedLock {
+public:
+    explicit TimedLock(std::shared_mutex& mutex) {
+        static const Timings timings = make_timings();
+        timings_ = &timings;
+
+        const auto requested = std::chrono::steady_clock::now();
+        lock_ = Lock(mutex);
+        acquired_ = std::chrono::steady_clock::now();
+        timings_->wait.observe(acquired_ - requested);
+    }
+
+    TimedLock(const TimedLock&) = delete;
+    TimedLock& operator=(const TimedLock&) = delete;
+
+    ~TimedLock() {
+        timings_->hold.observe(std::chrono::steady_clock::now() - acquired_);
+    }
+
+private:
+    struct Timings {
+        metrics::Histogram& wait;
+        metrics::Histogram& hold;
+    };
+
+    static Timings make_timings() {
+        constexpr bool shared = std::is_same_v<Lock, std::shared_lock<std::shared_mutex>>;
+        const std::string mode = metrics::labels({{"mode", shared ? "shared" : "exclusive"}});
+        return Timings{
+            metrics::registry().histogram(
+                "taskfarmer_task_service_lock_wait_seconds",
+                "Time spent waiting for the task tree lock.", mode),
+            metrics::registry().histogram(
+                "taskfarmer_task_service_lock_hold_seconds",
+                "Time the task tree lock was held once acquired.", mode),
+        };
+    }
+
+    const Timings* timings_;
+    Lock lock_;
+    std::chrono::steady_clock::time_point acquired_;
+};
+
+using SharedLock = TimedLock<std::shared_lock<std::shared_mutex>>;
+using ExclusiveLock = TimedLock<std::unique_lock<std::shared_mutex>>;
+
+// Facet buckets and rollups are indexed by status and priority, so values
+// that name no enumerator are refused before anything is touched.
+void require_valid(TaskStatus status, TaskPriority priority, const char* context) {
+    if (!is_valid_status(static_cast<long long>(status)) ||
+        !is_valid_priority(static_cast<long long>(priority))) {
+        throw std::invalid_argument(
+            std::string("[ERROR] ") + context + ": status or priority out of range."
+        );
+    }
+}
+
+void require_valid_drafts(const std::vector<TaskDraft>& drafts) {
+    for (const TaskDraft& draft : drafts) {
+        require_valid(draft.status, draft.priority, "create_batch");
+        require_valid_drafts(draft.children);
+    }
+}
+
+} // namespace
+
+TaskService::TaskService(Database& db, TaskServiceConfig config)
+    : db_(db), config_(config) {
+    load_workspace();
+    journal_ = std::make_unique<WriteJournal>(db_, config_.journal);
+
+    if (config_.read_connections > 0 && ReadConnectionPool::shareable(db_.path())) {
+        readers_ = std::make_unique<ReadConnectionPool>(db_.path(), config_.read_connections);
+    }
 }
 
 void TaskService::init() {
+    ExclusiveLock lock(mutex_);
+    load_workspace();
+}
+
+void TaskService::load_workspace() {
+    if (journal_) {
+        journal_->flush();
+        failed_writes_seen_ = journal_->failed_jobs();
+    }
+
     db_.open();
     db_.init_schema();
     db_.ensure_root();
 
     workspace_ = db_.load_tree("ROOT");
+
+    index_.clear();
+    facets_.clear();
+    index_subtree(workspace_);
+
+    if (config_.snapshot_reads) {
+        publish_all();
+    }
+}
+
+void TaskService::index_subtree(const TaskNode::Ptr& root) {
+    std::vector<TaskNode::Ptr> pending{root};
+
+    while (!pending.empty()) {
+        TaskNode::Ptr node = std::move(pending.back());
+        pending.pop_back();
+
+        for (const auto& child : node->get_children()) {
+            if (child) {
+                pending.push_back(child);
+            }
+        }
+
+        index_node(node);
+    }
+}
+
+void TaskService::index_node(const TaskNode::Ptr& node) {
+    index_.insert_or_assign(node->get_id(), node);
+    if (const TaskNode* parent = node->get_parent()) {
+        facet_insert(*parent, node);
+    }
+}
+
+void TaskService::facet_insert(const TaskNode& parent, const TaskNode::Ptr& node) {
+    ChildFacets& facets = facets_[parent.get_id()];
+    facets.by_status[static_cast<std::size_t>(node->get_status())].insert(node);
+    facets.by_priority[static_cast<std::size_t>(node->get_priority())].insert(node);
+}
+
+void TaskService::facet_erase(const TaskNode& parent, const TaskNode::Ptr& node) {
+    const auto it = facets_.find(parent.get_id());
+    if (it == facets_.end()) {
+        return;
+    }
+    it->second.by_status[static_cast<std::size_t>(node->get_status())].erase(node);
+    it->second.by_priority[static_cast<std::size_t>(node->get_priority())].erase(node);
+}
+
+void TaskService::unindex_subtree(const TaskNode::Ptr& root) {
+    std::vector<const TaskNode*> pending{root.get()};
+
+    while (!pending.empty()) {
+        const TaskNode* node = pending.back();
+        pending.pop_back();
+
+        for (const auto& child : node->get_children()) {
+            if (child) {
+                pending.push_back(child.get());
+            }
+        }
+
+        index_.erase(node->get_id());
+        facets_.erase(node->get_id());
+    }
+}
+
+std::size_t TaskService::snapshot_shard(std::string_view parent_id) {
+    return std::hash<std::string_view>{}(parent_id) % kSnapshotShards;
+}
+
+void TaskService::publish_all() {
+    std::array<ListingMap, kSnapshotShards> shards;
+
+    for (const auto& [id, node] : index_) {
+        const auto& children = node->get_children();
+        if (children.empty()) {
+            continue;
+        }
+
+        auto listing = std::make_shared<Listing>();
+        listing->reserve(children.size());
+        for (const auto& child : children) {
+            listing->push_back(child->clone_detached());
+        }
+        shards[snapshot_shard(id)].emplace(id, std::move(listing));
+    }
+
+    auto snapshot = std::make_shared<Snapshot>();
+    for (std::size_t i = 0; i < kSnapshotShards; ++i) {
+        snapshot->shards[i] = std::make_shared<const ListingMap>(std::move(shards[i]));
+    }
+    snapshot_.store(std::move(snapshot));
+}
+
+void TaskService::publish_children(const TaskNode& parent, const TaskNode* changed) {
+    if (!config_.snapshot_reads) {
+        return;
+    }
+
+    const std::shared_ptr<const Snapshot> current = snapshot_.load();
+    const std::size_t shard = snapshot_shard(parent.get_id());
+
+    auto map = std::make_shared<ListingMap>(*current->shards[shard]);
+
+    const auto& children = parent.get_children();
+    if (children.empty()) {
+        map->erase(parent.get_id());
+    } else {
+        static const Listing kEmpty;
+        const auto old_it = map->find(parent.get_id());
+        const Listing& old = old_it == map->end() ? kEmpty : *old_it->second;
+
+        auto listing = std::make_shared<Listing>();
+        listing->reserve(children.size());
+
+        // Children only ever gain or lose entries between publishes, so the
+        // old listing is walked alongside the live one to find reusable
+        // copies in a single pass.
+        std::size_t j = 0;
+        for (const auto& child : children) {
+            std::size_t k = j;
+            while (k < old.size() && old[k]->get_id() != child->get_id()) {
+                ++k;
+            }
+
+            if (k < old.size() && child.get() != changed) {
+                listing->push_back(old[k]);
+                j = k + 1;
+            } else {
+                listing->push_back(child->clone_detached());
+                if (k < old.size()) {
+                    j = k + 1;
+                }
+            }
+        }
+
+        map->insert_or_assign(parent.get_id(), std::move(listing));
+    }
+
+    auto next = std::make_shared<Snapshot>(*current);
+    next->shards[shard] = std::move(map);
+    snapshot_.store(std::move(next));
+}
+
+void TaskService::publish_ancestors(const TaskNode& node) {
+    if (!config_.snapshot_reads) {
+        return;
+    }
+
+    for (const TaskNode* cur = &node; cur->get_parent(); cur = cur->get_parent()) {
+        publish_children(*cur->get_parent(), cur);
+    }
+}
+
+void TaskService::unpublish_subtree(const TaskNode::Ptr& root) {
+    if (!config_.snapshot_reads) {
+        return;
+    }
+
+    const std::shared_ptr<const Snapshot> current = snapshot_.load();
+    auto next = std::make_shared<Snapshot>(*current);
+    std::array<std::shared_ptr<ListingMap>, kSnapshotShards> copied;
+
+    std::vector<const TaskNode*> pending{root.get()};
+    while (!pending.empty()) {
+        const TaskNode* node = pending.back();
+        pending.pop_back();
+
+        if (!node->has_children()) {
+            continue;
+        }
+
+        for (const auto& child : node->get_children()) {
+            pending.push_back(child.get());
+        }
+
+        const std::size_t shard = snapshot_shard(node->get_id());
+        if (!copied[shard]) {
+            copied[shard] = std::make_shared<ListingMap>(*current->shards[shard]);
+            next->shards[shard] = copied[shard];
+        }
+        copied[shard]->erase(node->get_id());
+    }
+
+    snapshot_.store(std::move(next));
 }
 
 TaskNode::Ptr TaskService::workspace() const {
-    std::shared_lock lock(mutex_);
+    SharedLock lock(mutex_);
     require_initialised();
     return workspace_;
 }
 
 std::vector<TaskNode::Ptr> TaskService::ls(std::string_view absolute_path) const {
-    std::shared_lock lock(mutex_);
+    SharedLock lock(mutex_);
     require_initialised();
 
     TaskNode::Ptr parent = resolve_path(workspace_, absolute_path);
@@ -42,59 +318,64 @@ std::vector<TaskNode::Ptr> TaskService::ls(std::string_view absolute_path) const
 TaskNode::Ptr TaskService::create(std::string_view parent_path,
                                   std::string title,
                                   std::string description) {
-    std::unique_lock lock(mutex_);
-    require_initialised();
+    TaskNode::Ptr child_ptr;
+    std::future<void> written;
 
-    TaskNode::Ptr parent_ptr = resolve_path(workspace_, parent_path);
-    if (!parent_ptr) {
-        throw std::runtime_error("[ERROR] create: parent path not found.");
-    }
+    {
+        ExclusiveLock lock(mutex_);
+        require_initialised();
+        resync_after_failed_writes();
 
-    TaskNode child = db_.create_task_under(
-        parent_ptr->get_id(),
-        std::move(title),
-        std::move(description)
-    );
+        TaskNode::Ptr parent_ptr = resolve_path(workspace_, parent_path);
+        if (!parent_ptr) {
+            throw std::runtime_error("[ERROR] create: parent path not found.");
+        }
+
+        child_ptr = std::make_shared<TaskNode>(
+            std::move(title),
+            std::move(description)
+        );
 
-    TaskNode::Ptr child_ptr = std::make_shared<TaskNode>(child);
-    parent_ptr->add_child(child_ptr);
+        written = journal_->submit(
+            [row = child_ptr->clone_detached(), parent_id = parent_ptr->get_id()](
+                Database& db
+            ) {
+                db.insert_task(*row, parent_id);
+            }
+        );
 
+        parent_ptr->add_child(child_ptr);
+        index_node(child_ptr);
+        publish_children(*parent_ptr, child_ptr.get());
+        publish_ancestors(*parent_ptr);
+
+        // Handed out after the lock is released, so as a copy.
+        child_ptr = child_ptr->clone_detached();
+    }
+
+    await_write(written);
     return child_ptr;
 }
 
 TaskNode::Ptr TaskService::find(std::string_view absolute_path) const {
-    std::shared_lock lock(mutex_);
+    SharedLock lock(mutex_);
     require_initialised();
     return resolve_path(workspace_, absolute_path);
 }
 
+TaskNode::Ptr TaskService::find_by_id(std::string_view id) const {
+    SharedLock lock(mutex_);
+    return find_by_id_in_memory(id);
+}
+
 TaskNode::Ptr TaskService::find_by_id_in_memory(std::string_view id) const {
     require_initialised();
 
-    if (workspace_->get_id() == id) {
-        return workspace_;
+    const auto it = index_.find(id);
+    if (it == index_.end()) {
+        return nullptr;
     }
-
-    std::vector<TaskNode::Ptr> search_space{workspace_};
-
-    while (!search_space.empty()) {
-        TaskNode::Ptr current_node = search_space.back();
-        search_space.pop_back();
-
-        for (const auto& child : current_node->get_children()) {
-            if (!child) {
-                continue;
-            }
-
-            if (child->get_id() == id) {
-                return child;
-            }
-
-            search_space.push_back(child);
-        }
-    }
-
-    return nullptr;
+    return it->second;
 }
 
 bool TaskService::modify(std::string_view id,
@@ -102,28 +383,46 @@ bool TaskService::modify(std::string_view id,
                          std::optional<std::string> description,
                          std::optional<TaskStatus> status,
                          std::optional<TaskPriority> priority) {
-    std::unique_lock lock(mutex_);
-    require_initialised();
+    require_valid(status.value_or(TaskStatus::TODO),
+                  priority.value_or(TaskPriority::LOW), "modify");
 
-    TaskNode::Ptr node = find_by_id_in_memory(id);
-    if (!node) {
-        return false;
-    }
+    std::future<void> written;
 
-    if (node == workspace_) {
-        throw std::runtime_error("modify: refusing to modify workspace root");
-    }
+    {
+        ExclusiveLock lock(mutex_);
+        require_initialised();
+        resync_after_failed_writes();
 
-    if (title) node->set_title(*title);
-    if (description) node->set_description(*description);
-    if (status) node->set_status(*status);
-    if (priority) node->set_priority(*priority);
+        TaskNode::Ptr node = find_by_id_in_memory(id);
+        if (!node) {
+            return false;
+        }
+
+        if (node == workspace_) {
+            throw std::runtime_error("modify: refusing to modify workspace root");
+        }
 
-    const bool ok = db_.update_task_fields(*node);
-    if (!ok) {
-        throw std::runtime_error("modify: DB update failed");
+        const bool refacet = status || priority;
+        if (refacet) facet_erase(*node->get_parent(), node);
+
+        if (title) node->set_title(*title);
+        if (description) node->set_description(*description);
+        if (status) node->set_status(*status);
+        if (priority) node->set_priority(*priority);
+
+        if (refacet) facet_insert(*node->get_parent(), node);
+
+        written = journal_->submit([row = node->clone_detached()](Database& db) {
+            if (!db.update_task_fields(*row)) {
+                throw std::runtime_error("modify: DB update failed");
+            }
+        });
+
+        publish_children(*node->get_parent(), node.get());
+        if (refacet) publish_ancestors(*node->get_parent());
     }
 
+    await_write(written);
     return true;
 }
 
@@ -135,77 +434,582 @@ void TaskService::require_initialised() const {
     }
 }
 
+void TaskService::await_write(std::future<void>& written) {
+    // With Durability::IN_MEMORY the caller is acknowledged as soon as the
+    // job is queued; the tree is then repaired by the next write or sync().
+    if (config_.durability == Durability::WAL_COMMITTED) {
+        try {
+            written.get();
+        } catch (...) {
+            // The change is in memory but not in the database.
+            ExclusiveLock lock(mutex_);
+            resync_after_failed_writes();
+            throw;
+        }
+    }
+}
 
+void TaskService::resync_after_failed_writes() {
+    if (journal_->failed_jobs() == failed_writes_seen_) {
+        return;
+    }
 
-bool TaskService::persist(const TaskNode::Ptr& node) {
-    std::unique_lock lock(mutex_);
-    return db_.update_task_fields(*node);
+    // Mutations reach memory before their journal job runs, and a failed
+    // job leaves the database without them (the rest of its batch still
+    // commits). Jobs still queued may fail as well, so they are drained
+    // first; then the database is the whole truth and the tree, indexes
+    // and snapshot are rebuilt from it. mutex_ is held, so nothing new is
+    // queued meanwhile.
+    load_workspace();
 }
 
+void TaskService::sync() {
+    ExclusiveLock lock(mutex_);
+    journal_->flush();
+    resync_after_failed_writes();
+}
 
-bool TaskService::delete_subtree(std::string_view id) {
-    std::unique_lock lock(mutex_);
-    require_initialised();
+WriteJournal::Stats TaskService::journal_stats() const {
+    return journal_->stats();
+}
 
-    if (workspace_->get_id() == id) {
-        throw std::runtime_error(
-            "delete_subtree: refusing to delete root node"
-        );
+StatementCache::Stats TaskService::statement_cache_stats() const {
+    return db_.statement_cache_stats();
+}
+
+std::optional<ReadConnectionPool::Stats> TaskService::read_pool_stats() const {
+    if (!readers_) {
+        return std::nullopt;
     }
+    return readers_->stats();
+}
 
-    TaskNode::Ptr target = find_by_id_in_memory(id);
-    if (!target) {
-        return false; 
+TaskService::TreeStats TaskService::tree_stats() const {
+    SharedLock lock(mutex_);
+
+    TreeStats stats;
+    stats.tasks = index_.size();
+    if (index_.empty()) {
+        return stats;
     }
 
-    TaskNode* parent = target->get_parent();
-    if (!parent) {
-        throw std::runtime_error(
-            "delete_subtree: node has no parent"
-        );
+    // Heap blocks owned by a node: strings past the small-string buffer and
+    // the children vector. Sampled, since walking a large tree on every
+    // scrape would hold the lock too long.
+    constexpr std::size_t kSampleSize = 1024;
+    const auto string_heap = [](const std::string& text) -> std::size_t {
+        return text.capacity() > std::string().capacity() ? text.capacity() + 1 : 0;
+    };
+
+    std::size_t sampled = 0;
+    std::size_t sampled_heap = 0;
+    for (const auto& [id, node] : index_) {
+        sampled_heap += string_heap(node->get_id()) +
+                        string_heap(node->get_title()) +
+                        string_heap(node->get_description()) +
+                        node->get_children().capacity() * sizeof(TaskNode::Ptr);
+        if (++sampled == kSampleSize) {
+            break;
+        }
     }
 
-    const bool db_ok = db_.delete_subtree(id);
-    if (!db_ok) {
-        throw std::runtime_error(
-            "delete_subtree: DB delete failed"
-        );
+    // Per node: the TaskNode and its make_shared control block, the index
+    // entry with its own copy of the id, the slot in the parent's children
+    // and one node in each of the parent's two facet sets.
+    constexpr std::size_t kPointer = sizeof(void*);
+    std::size_t per_node = sizeof(TaskNode) + 2 * kPointer +
+                           sizeof(std::string) + sizeof(TaskNode::Ptr) + 2 * kPointer +
+                           sizeof(TaskNode::Ptr) +
+                           2 * (sizeof(TaskNode::Ptr) + 4 * kPointer);
+    per_node += sampled_heap / sampled;
+    if (config_.snapshot_reads) {
+        // Published listings hold a detached copy of every node.
+        per_node += sizeof(TaskNode) + 2 * kPointer + sizeof(TaskNode::Ptr) +
+                    sampled_heap / sampled;
     }
 
-    const bool removed =
-        parent->remove_child_by_id(std::string{id});
+    stats.estimated_bytes = per_node * stats.tasks;
+    return stats;
+}
 
-    if (!removed) {
-        throw std::runtime_error(
-            "delete_subtree: in-memory removal failed"
-        );
+bool TaskService::persist(const TaskNode::Ptr& node) {
+    std::future<void> written;
+
+    {
+        ExclusiveLock lock(mutex_);
+        resync_after_failed_writes();
+        written = journal_->submit([row = node->clone_detached()](Database& db) {
+            if (!db.update_task_fields(*row)) {
+                throw std::runtime_error("persist: DB update failed");
+            }
+        });
     }
 
+    await_write(written);
+    return true;
+}
+
+
+bool TaskService::delete_subtree(std::string_view id) {
+    std::future<void> written;
+
+    {
+        ExclusiveLock lock(mutex_);
+        require_initialised();
+        resync_after_failed_writes();
+
+        if (workspace_->get_id() == id) {
+            throw std::runtime_error(
+                "delete_subtree: refusing to delete root node"
+            );
+        }
+
+        TaskNode::Ptr target = find_by_id_in_memory(id);
+        if (!target) {
+            return false;
+        }
+
+        TaskNode* parent = target->get_parent();
+        if (!parent) {
+            throw std::runtime_error(
+                "delete_subtree: node has no parent"
+            );
+        }
+
+        facet_erase(*parent, target);
+
+        const bool removed =
+            parent->remove_child_by_id(std::string{id});
+
+        if (!removed) {
+            throw std::runtime_error(
+                "delete_subtree: in-memory removal failed"
+            );
+        }
+
+        written = journal_->submit([target_id = std::string{id}](Database& db) {
+            if (!db.delete_subtree(target_id)) {
+                throw std::runtime_error("delete_subtree: DB delete failed");
+            }
+        });
+
+        unindex_subtree(target);
+        unpublish_subtree(target);
+        publish_children(*parent);
+        publish_ancestors(*parent);
+    }
+
+    await_write(written);
     return true;
 }
 
 
 std::vector<TaskNode::Ptr>
 TaskService::ls_by_parent_id(std::string_view parent_id) const {
-    std::shared_lock lock(mutex_);
-    require_initialised();
+    if (config_.snapshot_reads) {
+        // Lock-free read of the last published version; never waits on a
+        // writer holding mutex_ across database I/O.
+        const std::shared_ptr<const Snapshot> snapshot = snapshot_.load();
+        if (!snapshot) {
+            throw std::runtime_error(
+                "[ERROR] The workspace snapshot is not published."
+            );
+        }
 
-    // Root case
-    if (parent_id == "ROOT") {
-        const auto& children = workspace_->get_children();
-        return std::vector<TaskNode::Ptr>(children.begin(), children.end());
+        const ListingMap& shard = *snapshot->shards[snapshot_shard(parent_id)];
+        const auto it = shard.find(parent_id);
+        if (it == shard.end()) {
+            return {};
+        }
+        return *it->second;
     }
 
+    SharedLock lock(mutex_);
+    require_initialised();
+
     // Find parent in memory
-    TaskNode::Ptr parent = find_by_id_in_memory(parent_id);
+    const TaskNode::Ptr parent =
+        parent_id == "ROOT" ? workspace_ : find_by_id_in_memory(parent_id);
     if (!parent) {
         return {};
     }
 
+    // Callers read the listing after the lock is released (the HTTP
+    // handler streams it), so they get copies, not nodes writers change.
     const auto& children = parent->get_children();
-    return std::vector<TaskNode::Ptr>(children.begin(), children.end());
+    std::vector<TaskNode::Ptr> listing;
+    listing.reserve(children.size());
+    for (const auto& child : children) {
+        listing.push_back(child->clone_detached());
+    }
+    return listing;
+}
+
+
+namespace {
+
+ChildPage page_of(const std::vector<TaskNode::Ptr>& listing,
+                  const std::optional<ChildCursor>& after,
+                  std::size_t limit) {
+    const auto first = after
+        ? TaskNode::first_after(listing, after->created_at, after->id)
+        : listing.begin();
+    const auto remaining = static_cast<std::size_t>(listing.end() - first);
+    const auto last = first + static_cast<std::ptrdiff_t>(std::min(limit, remaining));
+
+    ChildPage page;
+    page.items.assign(first, last);
+    if (last != listing.end() && !page.items.empty()) {
+        const TaskNode& tail = *page.items.back();
+        page.next = ChildCursor{tail.get_created_at(), tail.get_id()};
+    }
+    return page;
+}
+
+} // namespace
+
+std::string ChildCursor::encode() const {
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    const std::string raw = std::to_string(created_at) + ':' + id;
+    std::string token;
+    token.reserve(raw.size() * 2);
+    for (const unsigned char c : raw) {
+        token.push_back(kHex[c >> 4]);
+        token.push_back(kHex[c & 0xF]);
+    }
+    return token;
+}
+
+std::optional<ChildCursor> ChildCursor::decode(std::string_view token) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    };
+
+    if (token.empty() || token.size() % 2 != 0) {
+        return std::nullopt;
+    }
+
+    std::string raw;
+    raw.reserve(token.size() / 2);
+    for (std::size_t i = 0; i < token.size(); i += 2) {
+        const int hi = nibble(token[i]);
+        const int lo = nibble(token[i + 1]);
+        if (hi < 0 || lo < 0) {
+            return std::nullopt;
+        }
+        raw.push_back(static_cast<char>(hi << 4 | lo));
+    }
+
+    const auto colon = raw.find(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == raw.size()) {
+        return std::nullopt;
+    }
+
+    ChildCursor cursor;
+    long long created_at = 0;
+    const auto [end, ec] = std::from_chars(raw.data(), raw.data() + colon, created_at);
+    if (ec != std::errc() || end != raw.data() + colon) {
+        return std::nullopt;
+    }
+    cursor.created_at = static_cast<std::time_t>(created_at);
+    cursor.id = raw.substr(colon + 1);
+    return cursor;
+}
+
+ChildPage TaskService::ls_page(std::string_view parent_id,
+                               const std::optional<ChildCursor>& after,
+                               std::size_t limit) const {
+    if (config_.snapshot_reads) {
+        const std::shared_ptr<const Snapshot> snapshot = snapshot_.load();
+        if (!snapshot) {
+            throw std::runtime_error(
+                "[ERROR] The workspace snapshot is not published."
+            );
+        }
+
+        const ListingMap& shard = *snapshot->shards[snapshot_shard(parent_id)];
+        const auto it = shard.find(parent_id);
+        if (it == shard.end()) {
+            return {};
+        }
+        return page_of(*it->second, after, limit);
+    }
+
+    SharedLock lock(mutex_);
+    require_initialised();
+
+    const TaskNode::Ptr parent = find_by_id_in_memory(parent_id);
+    if (!parent) {
+        return {};
+    }
+
+    // Copied for the same reason as in ls_by_parent_id; only the page is.
+    ChildPage page = page_of(parent->get_children(), after, limit);
+    for (auto& item : page.items) {
+        item = item->clone_detached();
+    }
+    return page;
+}
+
+std::vector<TaskSearchResult> TaskService::search(std::string_view text,
+                                                 std::size_t limit,
+                                                 std::size_t offset) const {
+    // The database query runs without mutex_, on a read connection when
+    // there are any, so it neither waits for nor sees the journal's open
+    // transaction; only resolving the hits against the tree needs the lock.
+    // Without one it borrows the writer's connection between batches.
+    std::vector<Database::SearchHit> hits;
+    if (readers_) {
+        hits = readers_->acquire()->search_tasks(text, limit, offset);
+    } else {
+        journal_->with_connection([&](Database& db) {
+            hits = db.search_tasks(text, limit, offset);
+        });
+    }
+
+    std::vector<TaskSearchResult> results;
+    results.reserve(hits.size());
+
+    SharedLock lock(mutex_);
+    require_initialised();
+
+    for (const auto& hit : hits) {
+        const TaskNode::Ptr node = find_by_id_in_memory(hit.task.get_id());
+        if (!node || node == workspace_) {
+            continue;
+        }
+        // A copy: callers read it after the lock is released.
+        results.push_back(TaskSearchResult{
+            node->clone_detached(),
+            node->get_path(),
+            hit.score
+        });
+    }
+    return results;
+}
+
+TaskQueryResult TaskService::query_children(std::string_view parent_id,
+                                            const TaskQuery& query) const {
+    for (const TaskStatus status : query.statuses) {
+        require_valid(status, TaskPriority::LOW, "query_children");
+    }
+    for (const TaskPriority priority : query.priorities) {
+        require_valid(TaskStatus::TODO, priority, "query_children");
+    }
+
+    TaskQueryResult result;
+
+    SharedLock lock(mutex_);
+    require_initialised();
+
+    const TaskNode::Ptr parent = find_by_id_in_memory(parent_id);
+    if (!parent) {
+        return result;
+    }
+
+    const auto updated_ok = [&](const TaskNode::Ptr& task) {
+        return !query.updated_since || task->get_updated_at() >= *query.updated_since;
+    };
+    const auto status_ok = [&](const TaskNode::Ptr& task) {
+        return query.statuses.empty() ||
+               std::find(query.statuses.begin(), query.statuses.end(),
+                         task->get_status()) != query.statuses.end();
+    };
+    const auto priority_ok = [&](const TaskNode::Ptr& task) {
+        return query.priorities.empty() ||
+               std::find(query.priorities.begin(), query.priorities.end(),
+                         task->get_priority()) != query.priorities.end();
+    };
+
+    std::vector<TaskNode::Ptr>& matches = result.items;
+
+    const auto facets_it = facets_.find(parent_id);
+    if (query.statuses.empty() && query.priorities.empty()) {
+        for (const auto& child : parent->get_children()) {
+            if (updated_ok(child)) {
+                matches.push_back(child);
+            }
+        }
+    } else if (facets_it != facets_.end()) {
+        const ChildFacets& facets = facets_it->second;
+
+        // Walk whichever indexed filter selects fewer rows and check the
+        // other one per row.
+        std::vector<const FacetBucket*> by_status;
+        std::size_t status_rows = 0;
+        for (const TaskStatus status : query.statuses) {
+            by_status.push_back(&facets.by_status[static_cast<std::size_t>(status)]);
+            status_rows += by_status.back()->size();
+        }
+        std::vector<const FacetBucket*> by_priority;
+        std::size_t priority_rows = 0;
+        for (const TaskPriority priority : query.priorities) {
+            by_priority.push_back(&facets.by_priority[static_cast<std::size_t>(priority)]);
+            priority_rows += by_priority.back()->size();
+        }
+
+        const bool use_status = !query.statuses.empty() &&
+            (query.priorities.empty() || status_rows <= priority_rows);
+
+        // Repeated filter values must not list a row twice.
+        auto& buckets = use_status ? by_status : by_priority;
+        std::sort(buckets.begin(), buckets.end());
+        buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+
+        for (const FacetBucket* bucket : buckets) {
+            for (const auto& child : *bucket) {
+                if (updated_ok(child) &&
+                    (use_status ? priority_ok(child) : status_ok(child))) {
+                    matches.push_back(child);
+                }
+            }
+        }
+    }
+
+    result.matched = matches.size();
+
+    const auto rank = [&](const TaskNode::Ptr& a, const TaskNode::Ptr& b) {
+        switch (query.sort) {
+            case TaskSortKey::UPDATED_AT:
+                if (a->get_updated_at() != b->get_updated_at())
+                    return a->get_updated_at() < b->get_updated_at();
+                break;
+            case TaskSortKey::PRIORITY:
+                if (a->get_priority() != b->get_priority())
+                    return a->get_priority() < b->get_priority();
+                break;
+            case TaskSortKey::STATUS:
+                if (a->get_status() != b->get_status())
+                    return a->get_status() < b->get_status();
+                break;
+            case TaskSortKey::TITLE:
+                if (a->get_title() != b->get_title())
+                    return a->get_title() < b->get_title();
+                break;
+            case TaskSortKey::CREATED_AT:
+                break;
+        }
+        return TaskNode::ordered_before(a, b->get_created_at(), b->get_id());
+    };
+    const auto before = [&](const TaskNode::Ptr& a, const TaskNode::Ptr& b) {
+        return query.descending ? rank(b, a) : rank(a, b);
+    };
+
+    const std::size_t keep = std::min(query.limit, matches.size());
+    std::partial_sort(matches.begin(),
+                      matches.begin() + static_cast<std::ptrdiff_t>(keep),
+                      matches.end(), before);
+    matches.resize(keep);
+
+    // Callers serialise the rows after the lock is released, while
+    // writers may change the live nodes, so they get copies.
+    for (auto& item : matches) {
+        item = item->clone_detached();
+    }
+
+    return result;
 }
 
+namespace {
+
+// Breadth-first walk shared by the live and snapshot variants of
+// ls_subtree. `children_of(id)` returns the children of a node, or nullptr
+// if it has none. With `detach`, the listing holds copies of the nodes
+// rather than the nodes themselves.
+template <typename ChildrenOf>
+SubtreeListing collect_subtree(const std::vector<TaskNode::Ptr>& top,
+                               std::size_t depth,
+                               std::size_t max_nodes,
+                               bool detach,
+                               ChildrenOf&& children_of) {
+    SubtreeListing out;
+
+    struct Pending {
+        std::vector<TaskSubtree>* slot;
+        const std::vector<TaskNode::Ptr>* children;
+        std::size_t level;
+    };
+    std::deque<Pending> pending{{&out.children, &top, 1}};
+
+    while (!pending.empty()) {
+        const Pending next = pending.front();
+        pending.pop_front();
+
+        // Reserved up front so the pointers queued below stay valid.
+        next.slot->reserve(next.children->size());
+
+        for (const auto& child : *next.children) {
+            if (out.node_count == max_nodes) {
+                out.truncated = true;
+                return out;
+            }
+
+            const std::vector<TaskNode::Ptr>* grandchildren =
+                children_of(child->get_id());
+
+            TaskSubtree& entry = next.slot->emplace_back();
+            entry.node = detach ? child->clone_detached() : child;
+            entry.has_children = grandchildren && !grandchildren->empty();
+            ++out.node_count;
+
+            if (entry.has_children && next.level < depth) {
+                entry.expanded = true;
+                pending.push_back({&entry.children, grandchildren, next.level + 1});
+            }
+        }
+    }
+
+    return out;
+}
+
+} // namespace
+
+std::optional<SubtreeListing> TaskService::ls_subtree(std::string_view root_id,
+                                                      std::size_t depth,
+                                                      std::size_t max_nodes) const {
+    if (depth == 0) {
+        depth = 1;
+    }
+
+    if (config_.snapshot_reads) {
+        const std::shared_ptr<const Snapshot> snapshot = snapshot_.load();
+        if (!snapshot) {
+            throw std::runtime_error(
+                "[ERROR] The workspace snapshot is not published."
+            );
+        }
+
+        auto children_of = [&](std::string_view id) -> const Listing* {
+            const ListingMap& shard = *snapshot->shards[snapshot_shard(id)];
+            const auto it = shard.find(id);
+            return it == shard.end() ? nullptr : it->second.get();
+        };
+
+        static const Listing kEmpty;
+        const Listing* top = children_of(root_id);
+        // Published listings are copies already.
+        return collect_subtree(top ? *top : kEmpty, depth, max_nodes, false, children_of);
+    }
+
+    SharedLock lock(mutex_);
+    require_initialised();
+
+    const TaskNode::Ptr root = find_by_id_in_memory(root_id);
+    if (!root) {
+        return std::nullopt;
+    }
+
+    auto children_of = [&](std::string_view id) -> const std::vector<TaskNode::Ptr>* {
+        const TaskNode::Ptr node = find_by_id_in_memory(id);
+        return node ? &node->get_children() : nullptr;
+    };
+
+    // Callers serialise the listing after the lock is released.
+    return collect_subtree(root->get_children(), depth, max_nodes, true, children_of);
+}
 
 TaskNode::Ptr TaskService::create_with_parent_id(
     std::string_view parent_id,
@@ -214,43 +1018,141 @@ TaskNode::Ptr TaskService::create_with_parent_id(
     TaskStatus status,
     TaskPriority priority
 ) {
-    std::unique_lock lock(mutex_);
-    require_initialised();
+    require_valid(status, priority, "create_with_parent_id");
 
-    TaskNode::Ptr parent;
+    TaskNode::Ptr child_ptr;
+    std::future<void> written;
 
-    if (parent_id == "ROOT") {
-        parent = workspace_;
-    } else {
-        parent = find_by_id_in_memory(parent_id);
-    }
+    {
+        ExclusiveLock lock(mutex_);
+        require_initialised();
+        resync_after_failed_writes();
 
-    if (!parent) {
-        throw std::runtime_error(
-            "create_with_parent_id: parent not found"
-        );
-    }
+        TaskNode::Ptr parent;
 
-    TaskNode child = db_.create_task_under(
-        parent->get_id(),
-        std::string{title},
-        std::move(description)
-    );
+        if (parent_id == "ROOT") {
+            parent = workspace_;
+        } else {
+            parent = find_by_id_in_memory(parent_id);
+        }
 
-    TaskNode::Ptr child_ptr =
-        std::make_shared<TaskNode>(std::move(child));
+        if (!parent) {
+            throw std::runtime_error(
+                "create_with_parent_id: parent not found"
+            );
+        }
 
-    child_ptr->set_status(status);
-    child_ptr->set_priority(priority);
+        child_ptr = std::make_shared<TaskNode>(
+            std::string{title},
+            std::move(description)
+        );
 
-    const bool ok = db_.update_task_fields(*child_ptr);
-    if (!ok) {
-        throw std::runtime_error(
-            "create_with_parent_id: failed to persist fields"
+        child_ptr->set_status(status);
+        child_ptr->set_priority(priority);
+
+        // The row already carries status and priority, so one INSERT
+        // replaces the old insert-then-update pair.
+        written = journal_->submit(
+            [row = child_ptr->clone_detached(), parent_id = parent->get_id()](
+                Database& db
+            ) {
+                db.insert_task(*row, parent_id);
+            }
         );
-    }
 
-    parent->add_child(child_ptr);
+        parent->add_child(child_ptr);
+        index_node(child_ptr);
+        publish_children(*parent, child_ptr.get());
+        publish_ancestors(*parent);
 
+        // Handed out after the lock is released, so as a copy.
+        child_ptr = child_ptr->clone_detached();
+    }
+
+    await_write(written);
     return child_ptr;
-}
\ No newline at end of file
+}
+
+std::vector<TaskNode::Ptr> TaskService::create_batch(
+    std::string_view parent_id,
+    const std::vector<TaskDraft>& drafts
+) {
+    require_valid_drafts(drafts);
+
+    std::vector<TaskNode::Ptr> created;
+    std::future<void> written;
+
+    {
+        ExclusiveLock lock(mutex_);
+        require_initialised();
+        resync_after_failed_writes();
+
+        TaskNode::Ptr parent;
+
+        if (parent_id == "ROOT") {
+            parent = workspace_;
+        } else {
+            parent = find_by_id_in_memory(parent_id);
+        }
+
+        if (!parent) {
+            throw std::runtime_error(
+                "create_batch: parent not found"
+            );
+        }
+
+        // Rows are queued parent-first so every INSERT finds its parent.
+        std::vector<std::pair<TaskNode::Ptr, std::string>> rows;
+        std::vector<TaskNode*> parents_with_new_children{parent.get()};
+
+        struct Frame {
+            TaskNode* parent;
+            const std::vector<TaskDraft>* drafts;
+        };
+        std::vector<Frame> pending{{parent.get(), &drafts}};
+
+        while (!pending.empty()) {
+            const Frame frame = pending.back();
+            pending.pop_back();
+
+            for (const TaskDraft& draft : *frame.drafts) {
+                auto child_ptr = std::make_shared<TaskNode>(
+                    draft.title,
+                    draft.description
+                );
+                child_ptr->set_status(draft.status);
+                child_ptr->set_priority(draft.priority);
+
+                rows.emplace_back(child_ptr->clone_detached(), frame.parent->get_id());
+
+                frame.parent->add_child(child_ptr);
+                index_node(child_ptr);
+                created.push_back(child_ptr);
+
+                if (!draft.children.empty()) {
+                    parents_with_new_children.push_back(child_ptr.get());
+                    pending.push_back({child_ptr.get(), &draft.children});
+                }
+            }
+        }
+
+        written = journal_->submit([rows = std::move(rows)](Database& db) {
+            for (const auto& [row, row_parent_id] : rows) {
+                db.insert_task(*row, row_parent_id);
+            }
+        });
+
+        for (const TaskNode* touched : parents_with_new_children) {
+            publish_children(*touched);
+        }
+        publish_ancestors(*parent);
+
+        // Copied once every child is linked, so their rollups are complete.
+        for (auto& node : created) {
+            node = node->clone_detached();
+        }
+    }
+
+    await_write(written);
+    return created;
+}
@@ -0,0 +1,134 @@
+#include "../include/WorkerPool.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+thread_local bool shed_current = false;
+thread_local std::chrono::steady_clock::duration queue_wait_current{};
+
+} // namespace
+
+WorkerPool::WorkerPool(std::size_t threads, std::size_t max_queued,
+                       std::function<void()> on_connection_end)
+    : max_queued_(max_queued),
+      on_connection_end_(std::move(on_connection_end)),
+      depth_(metrics::registry().gauge(
+          "taskfarmer_http_queue_depth",
+          "Accepted connections waiting for a worker, including those to be shed.")),
+      shed_total_(metrics::registry().counter(
+          "taskfarmer_http_queue_shed_total",
+          "Connections answered with 503 because the queue was full.")),
+      rejected_total_(metrics::registry().counter(
+          "taskfarmer_http_queue_rejected_total",
+          "Connections closed unanswered because the shed queue was full too.")),
+      queue_wait_(metrics::registry().histogram(
+          "taskfarmer_http_queue_wait_seconds",
+          "Time accepted connections waited for a worker.")) {
+    if (threads == 0) {
+        throw std::runtime_error("[ERROR] WorkerPool: threads must be positive.");
+    }
+
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] { run(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+bool WorkerPool::enqueue(std::function<void()> fn) {
+    {
+        std::lock_guard lock(mutex_);
+        if (shutdown_) {
+            return false;
+        }
+
+        Job job{std::move(fn), std::chrono::steady_clock::now()};
+        if (max_queued_ == 0 || jobs_.size() < max_queued_) {
+            jobs_.push_back(std::move(job));
+        } else if (shed_.size() < max_queued_) {
+            shed_.push_back(std::move(job));
+        } else {
+            rejected_total_.add();
+            return false;
+        }
+        depth_.set(static_cast<std::int64_t>(jobs_.size() + shed_.size()));
+    }
+    ready_.notify_one();
+    return true;
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard lock(mutex_);
+        if (shutdown_) {
+            return;
+        }
+        shutdown_ = true;
+    }
+    ready_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+bool WorkerPool::take_shed_flag() {
+    return std::exchange(shed_current, false);
+}
+
+std::chrono::steady_clock::duration WorkerPool::take_queue_wait() {
+    return std::exchange(queue_wait_current, {});
+}
+
+void WorkerPool::run() {
+    while (true) {
+        Job job;
+        bool shed = false;
+        {
+            std::unique_lock lock(mutex_);
+            ready_.wait(lock, [this] {
+                return shutdown_ || !jobs_.empty() || !shed_.empty();
+            });
+            if (jobs_.empty() && shed_.empty()) {
+                return;  // shut down and drained
+            }
+
+            // Shed connections first: each costs one short 503.
+            std::deque<Job>& source = shed_.empty() ? jobs_ : shed_;
+            shed = !shed_.empty();
+            job = std::move(source.front());
+            source.pop_front();
+            depth_.set(static_cast<std::int64_t>(jobs_.size() + shed_.size()));
+        }
+
+        const auto waited = std::chrono::steady_clock::now() - job.enqueued;
+        if (shed) {
+            shed_total_.add();
+        } else {
+            queue_wait_.observe(waited);
+        }
+
+        // Undone even if the job throws.
+        struct ConnectionScope {
+            const std::function<void()>& on_end;
+
+            ~ConnectionScope() {
+                shed_current = false;
+                queue_wait_current = {};
+                if (on_end) {
+                    on_end();
+                }
+            }
+        };
+
+        shed_current = shed;
+        queue_wait_current = waited;
+        ConnectionScope scope{on_connection_end_};
+        job.fn();
+    }
+}
@@ -0,0 +1,206 @@
+// WriteJournal.cpp
+#include "../include/WriteJournal.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const char* kJobSavepoint = "journal_job";
+
+} // namespace
+
+WriteJournal::WriteJournal(Database& db, WriteJournalConfig config)
+    : db_(db), config_(config) {
+    if (config_.capacity == 0) {
+        throw std::invalid_argument("WriteJournal: capacity must be positive");
+    }
+    if (config_.max_batch == 0) {
+        throw std::invalid_argument("WriteJournal: max_batch must be positive");
+    }
+
+    stats_.capacity = config_.capacity;
+    worker_ = std::thread([this] { run(); });
+}
+
+WriteJournal::~WriteJournal() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    not_empty_.notify_all();
+    worker_.join();
+}
+
+std::future<void> WriteJournal::submit(Job job) {
+    std::unique_lock lock(mutex_);
+
+    if (stopping_) {
+        throw std::runtime_error("[ERROR] WriteJournal::submit: journal is stopping.");
+    }
+
+    if (queue_.size() >= config_.capacity) {
+        const auto start = std::chrono::steady_clock::now();
+        not_full_.wait(lock, [this] { return queue_.size() < config_.capacity; });
+
+        ++stats_.blocked_submits;
+        stats_.blocked_ns += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start
+            ).count()
+        );
+    }
+
+    Pending& pending = queue_.emplace_back(Pending{std::move(job), {}});
+    std::future<void> done = pending.done.get_future();
+
+    ++stats_.submitted;
+    if (queue_.size() > stats_.max_depth) {
+        stats_.max_depth = queue_.size();
+    }
+
+    lock.unlock();
+    not_empty_.notify_one();
+    return done;
+}
+
+void WriteJournal::flush() {
+    std::unique_lock lock(mutex_);
+    drained_.wait(lock, [this] { return queue_.empty() && !busy_; });
+}
+
+void WriteJournal::with_connection(const Job& fn) {
+    std::lock_guard connection(connection_mutex_);
+    fn(db_);
+}
+
+WriteJournal::Stats WriteJournal::stats() const {
+    std::lock_guard lock(mutex_);
+    Stats out = stats_;
+    out.depth = queue_.size();
+    return out;
+}
+
+void WriteJournal::run() {
+    std::unique_lock lock(mutex_);
+
+    while (true) {
+        not_empty_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+
+        if (queue_.empty()) {
+            // stopping_ and fully drained.
+            return;
+        }
+
+        std::vector<Pending> batch;
+        const auto deadline =
+            std::chrono::steady_clock::now() + config_.batch_window;
+
+        while (batch.size() < config_.max_batch) {
+            if (!queue_.empty()) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+                continue;
+            }
+
+            if (stopping_ || config_.batch_window.count() == 0) {
+                break;
+            }
+
+            if (!not_empty_.wait_until(lock, deadline, [this] {
+                    return stopping_ || !queue_.empty();
+                })) {
+                break;
+            }
+        }
+
+        busy_ = true;
+        lock.unlock();
+        not_full_.notify_all();
+
+        {
+            std::lock_guard connection(connection_mutex_);
+            commit_batch(batch);
+        }
+
+        lock.lock();
+        busy_ = false;
+        ++stats_.batches;
+        if (batch.size() > stats_.max_batch) {
+            stats_.max_batch = batch.size();
+        }
+        if (queue_.empty()) {
+            drained_.notify_all();
+        }
+    }
+}
+
+void WriteJournal::commit_batch(std::vector<Pending>& batch) {
+    std::vector<std::exception_ptr> errors(batch.size());
+
+    try {
+        db_.begin();
+
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            db_.savepoint(kJobSavepoint);
+            try {
+                batch[i].job(db_);
+                db_.release_savepoint(kJobSavepoint);
+            } catch (...) {
+                errors[i] = std::current_exception();
+                db_.rollback_to_savepoint(kJobSavepoint);
+                db_.release_savepoint(kJobSavepoint);
+            }
+        }
+
+        db_.commit();
+    } catch (...) {
+        // BEGIN/COMMIT (or a savepoint) itself failed: nothing in the batch
+        // is durable, so every caller gets the error.
+        try {
+            db_.rollback();
+        } catch (...) {
+            // No transaction was open.
+        }
+        const std::exception_ptr batch_error = std::current_exception();
+        for (auto& error : errors) {
+            error = batch_error;
+        }
+    }
+
+    std::uint64_t completed = 0;
+    std::uint64_t failed = static_cast<std::uint64_t>(
+        std::count_if(errors.begin(), errors.end(),
+                      [](const std::exception_ptr& error) { return error != nullptr; }));
+
+    // Published before any future is settled: a caller that sees its job
+    // fail must also see the count move.
+    failed_jobs_.fetch_add(failed, std::memory_order_release);
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        if (!errors[i]) {
+            batch[i].done.set_value();
+            ++completed;
+            continue;
+        }
+
+        // With Durability::IN_MEMORY nobody waits on the future, so the
+        // failure is also reported here.
+        try {
+            std::rethrow_exception(errors[i]);
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "[ERROR] WriteJournal: %s\n", e.what());
+        } catch (...) {
+            std::fprintf(stderr, "[ERROR] WriteJournal: unknown error\n");
+        }
+        batch[i].done.set_exception(errors[i]);
+    }
+
+    std::lock_guard lock(mutex_);
+    stats_.completed += completed;
+    stats_.failed += failed;
+}
@@ -0,0 +1,74 @@
+#ifndef TASKFARMER_V2_TESTS_CHECK_HPP
+#define TASKFARMER_V2_TESTS_CHECK_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+// Minimal checks for the test executables. A failing CHECK reports itself
+// and the test carries on; main returns check::result(), which is non-zero
+// if anything failed, for ctest.
+namespace check {
+
+inline int failures = 0;
+
+inline void fail(const char* what, const char* file, int line) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    ++failures;
+}
+
+inline int result() {
+    if (failures > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
+
+// A database file in the temp directory, removed (with its WAL files)
+// when the scope ends.
+class TempDb {
+public:
+    explicit TempDb(const std::string& name)
+        : path_((std::filesystem::temp_directory_path() /
+                 ("taskfarmer_" + name + "_" +
+                  std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+                  ".db")).string()) {}
+
+    ~TempDb() {
+        std::error_code ec;
+        for (const char* suffix : {"", "-wal", "-shm"}) {
+            std::filesystem::remove(path_ + suffix, ec);
+        }
+    }
+
+    TempDb(const TempDb&) = delete;
+    TempDb& operator=(const TempDb&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+} // namespace check
+
+#define CHECK(expr) ((expr) ? (void)0 : check::fail(#expr, __FILE__, __LINE__))
+
+#define CHECK_THROWS(stmt)                                          \
+    do {                                                            \
+        bool thrown_ = false;                                       \
+        try {                                                       \
+            stmt;                                                   \
+        } catch (const std::exception&) {                           \
+            thrown_ = true;                                         \
+        }                                                           \
+        if (!thrown_) {                                             \
+            check::fail("throws: " #stmt, __FILE__, __LINE__);      \
+        }                                                           \
+    } while (0)
+
+#endif //TASKFARMER_V2_TESTS_CHECK_HPP
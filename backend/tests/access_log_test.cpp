@@ -0,0 +1,179 @@
+// access_log_test.cpp
+//
+// AccessLog: the JSON lines it writes, sampling (with 5xx always kept),
+// path truncation, per-thread buffers and dropping once a buffer is full.
+
+#include "../include/AccessLog.hpp"
+#include "Check.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// Records through a fresh log into a temporary file and returns the lines
+// written once the log has shut down.
+template <typename Fn>
+std::vector<std::string> logged_lines(AccessLogConfig config, Fn&& record) {
+    std::FILE* file = std::tmpfile();
+    CHECK(file != nullptr);
+    config.out = file;
+    {
+        AccessLog log(config);
+        record(log);
+    }
+
+    std::vector<std::string> lines;
+    std::rewind(file);
+    std::string line;
+    for (int c; (c = std::fgetc(file)) != EOF;) {
+        if (c == '\n') {
+            lines.push_back(line);
+            line.clear();
+        } else {
+            line.push_back(static_cast<char>(c));
+        }
+    }
+    std::fclose(file);
+    return lines;
+}
+
+// The counters are process-wide, so any log reports them.
+AccessLog::Stats totals() {
+    AccessLogConfig config;
+    config.out = stderr;
+    return AccessLog(config).stats();
+}
+
+void writes_json_lines() {
+    const AccessLog::Stats before = totals();
+
+    const auto lines = logged_lines(AccessLogConfig{}, [](AccessLog& log) {
+        log.record("GET", "/api/ls?path=\"x\"", 200, 1500us, 42, "127.0.0.1");
+        log.record("POST", "/api/create", 201, 2ms, 0, "::1");
+    });
+    CHECK(lines.size() == 2);
+    if (lines.size() == 2) {
+        const auto first = nlohmann::json::parse(lines[0]);
+        CHECK(first["method"] == "GET");
+        CHECK(first["path"] == "/api/ls?path=\"x\"");
+        CHECK(first["status"] == 200);
+        CHECK(first["duration_us"] == 1500);
+        CHECK(first["bytes"] == 42);
+        CHECK(first["remote"] == "127.0.0.1");
+        CHECK(first["ts_ms"].get<long long>() > 0);
+        CHECK(nlohmann::json::parse(lines[1])["status"] == 201);
+    }
+    CHECK(totals().written == before.written + 2);
+}
+
+void rejects_bad_config() {
+    AccessLogConfig config;
+    config.out = nullptr;
+    CHECK_THROWS(AccessLog{config});
+    config.out = stderr;
+    config.sample_rate = 1.5;
+    CHECK_THROWS(AccessLog{config});
+    config.sample_rate = -0.1;
+    CHECK_THROWS(AccessLog{config});
+    config.sample_rate = 1.0;
+    config.buffer_entries = 0;
+    CHECK_THROWS(AccessLog{config});
+}
+
+void sampling_keeps_errors() {
+    AccessLogConfig none;
+    none.sample_rate = 0.0;
+    std::optional<AccessLog::Stats> before;
+    std::optional<AccessLog::Stats> after;
+    const auto lines = logged_lines(none, [&](AccessLog& log) {
+        before = log.stats();
+        for (int i = 0; i < 100; ++i) {
+            log.record("GET", "/api/ls", 200, 1ms, 10, "127.0.0.1");
+        }
+        log.record("GET", "/api/ls", 503, 1ms, 10, "127.0.0.1");
+        log.record("GET", "/api/ls", 500, 1ms, 10, "127.0.0.1");
+        after = log.stats();
+    });
+    CHECK(lines.size() == 2);
+    CHECK(after->sampled_out - before->sampled_out == 100);
+
+    AccessLogConfig quarter;
+    quarter.sample_rate = 0.25;
+    quarter.buffer_entries = 1 << 15;
+    const auto sampled = logged_lines(quarter, [](AccessLog& log) {
+        for (int i = 0; i < 20000; ++i) {
+            log.record("GET", "/api/ls", 200, 1ms, 10, "127.0.0.1");
+        }
+    });
+    CHECK(sampled.size() > 4000 && sampled.size() < 6000);
+}
+
+void truncates_long_fields() {
+    const std::string path(AccessLog::kMaxPath + 50, 'p');
+    const auto lines = logged_lines(AccessLogConfig{}, [&](AccessLog& log) {
+        log.record("VERYLONGMETHOD", path, 200, 1ms, 0, "127.0.0.1");
+    });
+    CHECK(lines.size() == 1);
+    if (lines.size() == 1) {
+        const auto entry = nlohmann::json::parse(lines[0]);
+        CHECK(entry["path"] == std::string(AccessLog::kMaxPath, 'p'));
+        CHECK(entry["method"] == std::string("VERYLONGMETHOD").substr(0, AccessLog::kMaxMethod));
+    }
+}
+
+void threads_log_independently() {
+    const auto lines = logged_lines(AccessLogConfig{}, [](AccessLog& log) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&log] {
+                for (int i = 0; i < 500; ++i) {
+                    log.record("GET", "/api/ls", 200, 1ms, 10, "127.0.0.1");
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+    CHECK(lines.size() == 2000);
+}
+
+void full_buffer_drops() {
+    // One slot and a writer that is not due for a long time: the first
+    // record fills the buffer and the rest are dropped, not waited on.
+    AccessLogConfig config;
+    config.buffer_entries = 1;
+    config.flush_interval = 60s;
+    std::optional<AccessLog::Stats> before;
+    std::optional<AccessLog::Stats> after;
+    const auto lines = logged_lines(config, [&](AccessLog& log) {
+        before = log.stats();
+        for (int i = 0; i < 5; ++i) {
+            log.record("GET", "/api/ls", 200, 1ms, 10, "127.0.0.1");
+        }
+        after = log.stats();
+    });
+    const auto dropped = after->dropped - before->dropped;
+    CHECK(dropped >= 1);
+    CHECK(lines.size() + dropped == 5);
+}
+
+} // namespace
+
+int main() {
+    writes_json_lines();
+    rejects_bad_config();
+    sampling_keeps_errors();
+    truncates_long_fields();
+    threads_log_independently();
+    full_buffer_drops();
+    return check::result();
+}
@@ -0,0 +1,150 @@
+// admission_test.cpp
+//
+// Outcomes of AdmissionController::admit: exempt and unknown routes, late
+// requests, reads beside busy writes, writes waiting within their
+// allowance and being turned away once it is full, and the bulk limit.
+
+#include "../include/AdmissionController.hpp"
+#include "Check.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using Outcome = AdmissionController::Outcome;
+using RouteClass = AdmissionController::RouteClass;
+using Ticket = AdmissionController::Ticket;
+
+constexpr std::chrono::milliseconds kBudget{500};
+
+// 2 workers kept for reads; of the other 6, by default 3 run writes and 3
+// are for waiting ones.
+constexpr std::size_t kWorkers = 8;
+
+AdmissionConfig test_config() {
+    AdmissionConfig config;
+    config.read_budget = kBudget;
+    config.write_budget = kBudget;
+    config.bulk_concurrency = 1;
+    return config;
+}
+
+void add_routes(AdmissionController& controller) {
+    controller.add_route("GET /health", RouteClass::EXEMPT);
+    controller.add_route("GET /api/ls", RouteClass::READ);
+    controller.add_route("PUT /api/modify", RouteClass::WRITE);
+    controller.add_route("POST /api/create", RouteClass::WRITE);
+    controller.add_route("POST /api/batch", RouteClass::BULK);
+}
+
+// Admits a request that gives up after 1ms of waiting, so it reports
+// TIMED_OUT when it would have waited and QUEUE_FULL when it could not.
+Outcome try_admit(AdmissionController& controller, std::string_view key, Ticket& ticket) {
+    return controller.admit(key, kBudget - 1ms, ticket);
+}
+
+void exempt_and_unknown_routes() {
+    AdmissionController controller(test_config(), kWorkers);
+    add_routes(controller);
+    Ticket ticket;
+    CHECK(controller.admit("GET /health", 10s, ticket) == Outcome::ADMITTED);
+    CHECK(controller.admit("GET /nowhere", 10s, ticket) == Outcome::ADMITTED);
+}
+
+void late_requests_time_out() {
+    AdmissionController controller(test_config(), kWorkers);
+    add_routes(controller);
+    Ticket ticket;
+    CHECK(controller.admit("GET /api/ls", kBudget, ticket) == Outcome::TIMED_OUT);
+    CHECK(controller.admit("PUT /api/modify", kBudget + 1ms, ticket) == Outcome::TIMED_OUT);
+    CHECK(controller.admit("PUT /api/modify", 0ms, ticket) == Outcome::ADMITTED);
+}
+
+void reads_ignore_writes() {
+    AdmissionController controller(test_config(), kWorkers);
+    add_routes(controller);
+    std::vector<Ticket> writes(3);
+    for (auto& ticket : writes) {
+        CHECK(controller.admit("PUT /api/modify", 0ms, ticket) == Outcome::ADMITTED);
+    }
+    std::vector<Ticket> reads(8);
+    for (auto& ticket : reads) {
+        CHECK(try_admit(controller, "GET /api/ls", ticket) == Outcome::ADMITTED);
+    }
+}
+
+void writes_wait_for_a_slot() {
+    AdmissionController controller(test_config(), kWorkers);
+    add_routes(controller);
+    std::vector<Ticket> running(3);
+    for (auto& ticket : running) {
+        CHECK(controller.admit("PUT /api/modify", 0ms, ticket) == Outcome::ADMITTED);
+    }
+
+    // Writes on any write route share the running slots.
+    Ticket late;
+    CHECK(try_admit(controller, "POST /api/create", late) == Outcome::TIMED_OUT);
+
+    Outcome waited = Outcome::QUEUE_FULL;
+    Ticket waiter;
+    std::thread thread([&] { waited = controller.admit("POST /api/create", 0ms, waiter); });
+    std::this_thread::sleep_for(50ms);
+    running.front().reset();
+    thread.join();
+    CHECK(waited == Outcome::ADMITTED);
+}
+
+void full_allowance_is_rejected() {
+    AdmissionConfig config = test_config();
+    config.write_waiting = 1;
+    AdmissionController controller(config, kWorkers);
+    add_routes(controller);
+
+    // 6 write workers, one of them for waiting: 5 run.
+    std::vector<Ticket> running(5);
+    for (auto& ticket : running) {
+        CHECK(controller.admit("PUT /api/modify", 0ms, ticket) == Outcome::ADMITTED);
+    }
+
+    Outcome waited = Outcome::QUEUE_FULL;
+    Ticket waiter;
+    std::thread thread([&] { waited = controller.admit("PUT /api/modify", 0ms, waiter); });
+
+    // Once the thread waits, the next write cannot.
+    std::this_thread::sleep_for(50ms);
+    Ticket rejected;
+    CHECK(try_admit(controller, "PUT /api/modify", rejected) == Outcome::QUEUE_FULL);
+
+    running.front().reset();
+    thread.join();
+    CHECK(waited == Outcome::ADMITTED);
+}
+
+void bulk_is_limited() {
+    AdmissionController controller(test_config(), kWorkers);
+    add_routes(controller);
+    Ticket bulk;
+    CHECK(controller.admit("POST /api/batch", 0ms, bulk) == Outcome::ADMITTED);
+
+    Ticket second;
+    CHECK(try_admit(controller, "POST /api/batch", second) == Outcome::TIMED_OUT);
+    Ticket write;
+    CHECK(try_admit(controller, "PUT /api/modify", write) == Outcome::ADMITTED);
+
+    bulk.reset();
+    CHECK(try_admit(controller, "POST /api/batch", second) == Outcome::ADMITTED);
+}
+
+} // namespace
+
+int main() {
+    exempt_and_unknown_routes();
+    late_requests_time_out();
+    reads_ignore_writes();
+    writes_wait_for_a_slot();
+    full_allowance_is_rejected();
+    bulk_is_limited();
+    return check::result();
+}
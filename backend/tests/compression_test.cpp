@@ -0,0 +1,156 @@
+// compression_test.cpp
+//
+// Accept-Encoding negotiation, gzip output that zlib can inflate, and the
+// per-encoding metrics a finished stream records.
+
+#include "../include/Compression.hpp"
+#include "../include/Metrics.hpp"
+#include "Check.hpp"
+
+#include <zlib.h>
+
+namespace {
+
+using compression::ContentEncoding;
+
+// The best encoding the build offers when a client accepts all of them.
+constexpr ContentEncoding kPreferred =
+#if defined(TASKFARMER_WITH_ZSTD)
+    ContentEncoding::ZSTD;
+#elif defined(TASKFARMER_WITH_BROTLI)
+    ContentEncoding::BROTLI;
+#else
+    ContentEncoding::GZIP;
+#endif
+
+std::string gunzip(const std::string& in) {
+    z_stream stream{};
+    inflateInit2(&stream, 15 + 16);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    stream.avail_in = static_cast<uInt>(in.size());
+
+    std::string out;
+    char buffer[16 * 1024];
+    int rc = Z_OK;
+    while (rc == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        rc = inflate(&stream, Z_NO_FLUSH);
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    CHECK(rc == Z_STREAM_END);
+    return out;
+}
+
+std::size_t count(const std::string& text, const std::string& needle) {
+    std::size_t n = 0;
+    for (auto pos = text.find(needle); pos != std::string::npos;
+         pos = text.find(needle, pos + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+void negotiates() {
+    using compression::negotiate;
+
+    CHECK(negotiate("") == ContentEncoding::IDENTITY);
+    CHECK(negotiate("identity") == ContentEncoding::IDENTITY);
+    CHECK(negotiate("deflate") == ContentEncoding::IDENTITY);
+    CHECK(negotiate("gzip") == ContentEncoding::GZIP);
+    CHECK(negotiate("GZip ; Q=0.5") == ContentEncoding::GZIP);
+    CHECK(negotiate("gzip;q=0") == ContentEncoding::IDENTITY);
+    CHECK(negotiate("gzip, deflate, br, zstd") == kPreferred);
+    CHECK(negotiate("*") == kPreferred);
+    CHECK(negotiate("*;q=0.5, gzip;q=1") == ContentEncoding::GZIP);
+    CHECK(negotiate("*, gzip;q=0") == (kPreferred == ContentEncoding::GZIP
+                                           ? ContentEncoding::IDENTITY
+                                           : kPreferred));
+    CHECK(negotiate("gzip;q=abc") == ContentEncoding::IDENTITY);
+#ifdef TASKFARMER_WITH_BROTLI
+    CHECK(negotiate("br;q=0.9, gzip;q=0.8") == ContentEncoding::BROTLI);
+    CHECK(negotiate("br;q=0.5, gzip") == ContentEncoding::GZIP);
+#endif
+}
+
+void content_types() {
+    CHECK(compression::compressible("application/json"));
+    CHECK(compression::compressible("application/json; charset=utf-8"));
+    CHECK(compression::compressible("text/plain; version=0.0.4"));
+    CHECK(!compression::compressible("image/png"));
+    CHECK(!compression::compressible(""));
+}
+
+void validates_levels() {
+    compression::CompressionConfig config;
+    compression::validate(config);
+
+    config.gzip_level = 0;
+    CHECK_THROWS(compression::validate(config));
+    config = {};
+    config.brotli_quality = 12;
+    CHECK_THROWS(compression::validate(config));
+    config = {};
+    config.zstd_level = 20;
+    CHECK_THROWS(compression::validate(config));
+}
+
+void gzip_round_trips() {
+    std::string json = "[";
+    for (int i = 0; i < 20000; ++i) {
+        json += "{\"id\":\"" + std::to_string(i) + "\",\"title\":\"task\"},";
+    }
+    json += "{}]";
+
+    const compression::CompressionConfig config;
+    const std::string whole = compression::compress(ContentEncoding::GZIP, config, json);
+    CHECK(whole.size() < json.size() / 5);
+    CHECK(gunzip(whole) == json);
+
+    // Chunk by chunk, as the streamed /api/ls does.
+    compression::Compressor compressor(ContentEncoding::GZIP, config);
+    std::string streamed;
+    for (std::size_t i = 0; i < json.size(); i += 4096) {
+        compressor.update(std::string_view(json).substr(i, 4096), streamed);
+    }
+    compressor.finish(streamed);
+    CHECK(gunzip(streamed) == json);
+
+    CHECK(gunzip(compression::compress(ContentEncoding::GZIP, config, "")).empty());
+    CHECK_THROWS(compression::Compressor(ContentEncoding::IDENTITY, config));
+}
+
+void records_metrics_per_family() {
+    compression::compress(ContentEncoding::GZIP, {}, "some text");
+
+    std::string out;
+    metrics::registry().render(out);
+    CHECK(out.find("taskfarmer_http_compression_cpu_seconds_count{encoding=\"gzip\"}") !=
+          std::string::npos);
+    CHECK(out.find("taskfarmer_http_compression_input_bytes_total{encoding=\"gzip\"}") !=
+          std::string::npos);
+
+    // Several labelled series still make one family with one header.
+    metrics::registry().gauge("taskfarmer_test_level", "Test.",
+                              metrics::labels({{"encoding", "gzip"}})).set(6);
+    metrics::registry().gauge("taskfarmer_test_level", "Test.",
+                              metrics::labels({{"encoding", "br"}})).set(5);
+    out.clear();
+    metrics::registry().render(out);
+    CHECK(count(out, "# HELP taskfarmer_test_level ") == 1);
+    CHECK(count(out, "# TYPE taskfarmer_test_level ") == 1);
+    CHECK(count(out, "\ntaskfarmer_test_level{") == 2);
+    CHECK(count(out, "# HELP taskfarmer_http_compression_cpu_seconds ") == 1);
+}
+
+} // namespace
+
+int main() {
+    negotiates();
+    content_types();
+    validates_levels();
+    gzip_round_trips();
+    records_metrics_per_family();
+    return check::result();
+}
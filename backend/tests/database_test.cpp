@@ -0,0 +1,248 @@
+// database_test.cpp
+//
+// Database against a real SQLite file: materialised paths and range
+// deletes, schema migration, full-text search and validation of stored
+// rows.
+
+#include "../include/Database.hpp"
+#include "Check.hpp"
+
+#include <sqlite3.h>
+
+#include <set>
+#include <string>
+
+namespace {
+
+// Runs `sql` on a second connection, as another tool writing to the file
+// would.
+void exec_raw(const std::string& path, const char* sql) {
+    sqlite3* db = nullptr;
+    sqlite3_open(path.c_str(), &db);
+    CHECK(sqlite3_exec(db, sql, nullptr, nullptr, nullptr) == SQLITE_OK);
+    sqlite3_close(db);
+}
+
+// Inserts a task with a chosen id under parent_id.
+void insert(Database& db, const std::string& id, const std::string& parent_id) {
+    CHECK(db.insert_task(TaskNode(id, "title " + id, "", TaskStatus::TODO,
+                                  TaskPriority::MEDIUM, 1, 1),
+                         parent_id));
+}
+
+void paths_and_range_delete() {
+    check::TempDb file("paths");
+    Database db(file.path());
+    db.open();
+    db.ensure_root();
+
+    // "a0" sorts just past every path under "a", at the range's bound.
+    insert(db, "a", "ROOT");
+    insert(db, "a1", "a");
+    insert(db, "a11", "a1");
+    insert(db, "a2", "a");
+    insert(db, "a0", "ROOT");
+    insert(db, "a.", "ROOT");
+
+    CHECK(db.get_task_id_path("a11") == "ROOT/a/a1/a11/");
+    CHECK(!db.get_task_id_path("missing"));
+    CHECK(db.render_path("a11") == "/title a/title a1/title a11/");
+    CHECK(db.count_descendants("a") == 3);
+    CHECK(db.count_descendants("ROOT") == 6);
+    CHECK(db.is_ancestor_of("a", "a11"));
+    CHECK(db.is_ancestor_of("ROOT", "a0"));
+    CHECK(!db.is_ancestor_of("a", "a0"));
+    CHECK(!db.is_ancestor_of("a", "a"));
+
+    CHECK(db.delete_subtree("a"));
+    CHECK(!db.delete_subtree("a"));
+    for (const char* id : {"a", "a1", "a11", "a2"}) {
+        CHECK(!db.get_task_by_id(id));
+    }
+    CHECK(db.get_task_by_id("a0") && db.get_task_by_id("a."));
+    CHECK(db.count_descendants("ROOT") == 2);
+}
+
+// Past kSearchRankWindow matches, pages are cut from one fixed ranking.
+void search_pages_share_one_window() {
+    check::TempDb file("window");
+    Database db(file.path());
+    db.open();
+    db.ensure_root();
+
+    const std::size_t total = Database::kSearchRankWindow + 100;
+    db.begin();
+    for (std::size_t i = 0; i < total; ++i) {
+        db.create_task_under("ROOT", "common " + std::to_string(i % 7), "");
+    }
+    db.commit();
+
+    std::set<std::string> seen;
+    std::size_t rows = 0;
+    double last_score = -1e300;
+    bool ordered = true;
+    for (std::size_t offset = 0;; offset += 300) {
+        const auto page = db.search_tasks("common", 300, offset);
+        if (page.empty()) {
+            break;
+        }
+        for (const auto& hit : page) {
+            ordered = ordered && hit.score >= last_score;
+            last_score = hit.score;
+            seen.insert(hit.task.get_id());
+            ++rows;
+        }
+    }
+    CHECK(rows == Database::kSearchRankWindow);
+    CHECK(seen.size() == rows);
+    CHECK(ordered);
+    CHECK(db.search_tasks("common", 10, Database::kSearchRankWindow).empty());
+}
+
+// Linking children on load must not touch their parents' updated_at.
+void load_keeps_timestamps() {
+    check::TempDb file("timestamps");
+    Database db(file.path());
+    db.open();
+    db.ensure_root();
+    insert(db, "p", "ROOT");
+    insert(db, "c", "p");
+
+    const TaskNode::Ptr root = db.load_tree("ROOT");
+    const TaskNode::Ptr parent = root->find_child_by_id("p");
+    CHECK(parent && parent->get_updated_at() == 1 && parent->get_created_at() == 1);
+    CHECK(parent && parent->get_children().size() == 1);
+    CHECK(parent && parent->get_rollup().descendants == 1);
+    CHECK(root->get_rollup().descendants == 2);
+}
+
+std::size_t hits(const Database& db, std::string_view text) {
+    return db.search_tasks(text, 10).size();
+}
+
+// The FTS table follows inserts, updates and deletes through its triggers.
+void search_follows_writes() {
+    check::TempDb file("search");
+    Database db(file.path());
+    db.open();
+    db.ensure_root();
+
+    const std::string report =
+        db.create_task_under("ROOT", "alpha report", "beta").get_id();
+    const std::string notes =
+        db.create_task_under("ROOT", "gamma", "alpha notes").get_id();
+
+    const auto found = db.search_tasks("alpha", 10);
+    CHECK(found.size() == 2);
+    CHECK(!found.empty() && found[0].task.get_id() == report);  // title outweighs
+    CHECK(!found.empty() && found[0].parent_id == "ROOT");
+    CHECK(hits(db, "alpha beta") == 1);
+    CHECK(db.search_tasks("alpha", 1, 1).size() == 1);
+
+    // Query syntax is matched literally rather than parsed.
+    CHECK(hits(db, "alpha OR") == 0);
+    CHECK(hits(db, "alph*") == 0);
+    CHECK(hits(db, "\"alpha") == 2);
+    CHECK(hits(db, "   ") == 0);
+
+    TaskNode renamed = *db.get_task_by_id(report);
+    renamed.set_title("delta report");
+    CHECK(db.update_task_fields(renamed));
+    CHECK(hits(db, "alpha") == 1);
+    CHECK(hits(db, "delta") == 1);
+
+    CHECK(db.delete_subtree(notes));
+    CHECK(hits(db, "alpha") == 0);
+
+    // A database without the index gets its existing rows indexed.
+    exec_raw(file.path(), R"sql(
+        DROP TRIGGER tasks_fts_insert;
+        DROP TRIGGER tasks_fts_delete;
+        DROP TRIGGER tasks_fts_update;
+        DROP TABLE tasks_fts;
+    )sql");
+    Database reopened(file.path());
+    reopened.open();
+    reopened.init_schema();
+    CHECK(hits(reopened, "delta") == 1);
+}
+
+// A database from before tasks.path (user_version 0) gets the column and
+// every row's path on open.
+void migrates_pathless_schema() {
+    check::TempDb file("migrate");
+    exec_raw(file.path(), R"sql(
+        CREATE TABLE tasks (
+            id          TEXT PRIMARY KEY,
+            parent_id   TEXT,
+            title       TEXT NOT NULL,
+            description TEXT NOT NULL,
+            status      INTEGER NOT NULL,
+            priority    INTEGER NOT NULL,
+            created_at  INTEGER NOT NULL,
+            updated_at  INTEGER NOT NULL
+        );
+        INSERT INTO tasks VALUES ('ROOT', NULL, '/', '', 0, 1, 1, 1);
+        INSERT INTO tasks VALUES ('p', 'ROOT', 'parent', '', 0, 1, 1, 1);
+        INSERT INTO tasks VALUES ('c', 'p', 'child', 'old text', 0, 1, 1, 1);
+    )sql");
+
+    Database db(file.path());
+    db.open();
+    db.init_schema();
+
+    CHECK(db.get_task_id_path("c") == "ROOT/p/c/");
+    CHECK(db.count_descendants("ROOT") == 2);
+    CHECK(db.load_tree("ROOT")->get_children().size() == 1);
+
+    sqlite3* raw = nullptr;
+    sqlite3_open(file.path().c_str(), &raw);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(raw, "PRAGMA user_version;", -1, &stmt, nullptr);
+    CHECK(sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) >= 1);
+    sqlite3_finalize(stmt);
+    sqlite3_close(raw);
+
+    // Migrating again is a no-op.
+    db.init_schema();
+    CHECK(db.get_task_id_path("p") == "ROOT/p/");
+}
+
+void rejects_out_of_range_enums() {
+    check::TempDb file("enums");
+    std::string id;
+    {
+        Database db(file.path());
+        db.open();
+        db.ensure_root();
+        id = db.create_task_under("ROOT", "task").get_id();
+    }
+
+    exec_raw(file.path(), ("UPDATE tasks SET status = 9 WHERE id = '" + id + "';").c_str());
+    {
+        Database db(file.path());
+        db.open();
+        CHECK_THROWS(db.get_task_by_id(id));
+        CHECK_THROWS(db.load_tree("ROOT"));
+    }
+
+    exec_raw(file.path(),
+             ("UPDATE tasks SET status = 0, priority = -1 WHERE id = '" + id + "';").c_str());
+    {
+        Database db(file.path());
+        db.open();
+        CHECK_THROWS(db.load_tree("ROOT"));
+    }
+}
+
+} // namespace
+
+int main() {
+    paths_and_range_delete();
+    migrates_pathless_schema();
+    search_follows_writes();
+    load_keeps_timestamps();
+    search_pages_share_one_window();
+    rejects_out_of_range_enums();
+    return check::result();
+}
@@ -0,0 +1,160 @@
+// read_connection_pool_test.cpp
+//
+// ReadConnectionPool over a file-backed database: which paths can be
+// shared, leasing and waiting for a connection, read-only connections
+// seeing the writer's commits, and TaskService::search running through
+// the pool.
+
+#include "../include/Database.hpp"
+#include "../include/ReadConnectionPool.hpp"
+#include "../include/TaskService.hpp"
+#include "Check.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+void insert(Database& db, const std::string& id, const std::string& title) {
+    CHECK(db.insert_task(TaskNode(id, title, "", TaskStatus::TODO, TaskPriority::MEDIUM, 1, 1),
+                         "ROOT"));
+}
+
+void shareable_paths() {
+    CHECK(ReadConnectionPool::shareable("tasks.db"));
+    CHECK(ReadConnectionPool::shareable("file:tasks.db?cache=shared"));
+    CHECK(!ReadConnectionPool::shareable(""));
+    CHECK(!ReadConnectionPool::shareable(":memory:"));
+    CHECK(!ReadConnectionPool::shareable("file:tasks?mode=memory&cache=shared"));
+    CHECK_THROWS(ReadConnectionPool(":memory:", 2));
+    CHECK_THROWS(ReadConnectionPool("tasks.db", 0));
+}
+
+void leases_wait_for_a_connection() {
+    check::TempDb file("pool_leases");
+    Database writer(file.path());
+    writer.open();
+    writer.ensure_root();
+
+    ReadConnectionPool pool(file.path(), 2);
+    auto first = std::make_unique<ReadConnectionPool::Lease>(pool.acquire());
+    ReadConnectionPool::Lease second = pool.acquire();
+    CHECK(&**first != &*second);
+    CHECK(second->read_only());
+    CHECK(pool.stats().in_use == 2);
+
+    std::atomic<bool> acquired{false};
+    std::thread waiter([&] {
+        ReadConnectionPool::Lease third = pool.acquire();
+        acquired = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    CHECK(!acquired);
+    first.reset();
+    waiter.join();
+    CHECK(acquired);
+
+    const ReadConnectionPool::Stats stats = pool.stats();
+    CHECK(stats.size == 2);
+    CHECK(stats.in_use == 1);
+    CHECK(stats.acquired == 3);
+    CHECK(stats.waits == 1);
+    CHECK(stats.wait_ns > 0);
+}
+
+void readers_see_commits() {
+    check::TempDb file("pool_commits");
+    Database writer(file.path());
+    writer.open();
+    writer.ensure_root();
+
+    ReadConnectionPool pool(file.path(), 1);
+    CHECK(pool.acquire()->search_tasks("needle", 10, 0).empty());
+
+    insert(writer, "n1", "needle one");
+    {
+        const auto lease = pool.acquire();
+        const auto hits = lease->search_tasks("needle", 10, 0);
+        CHECK(hits.size() == 1 && hits[0].task.get_id() == "n1");
+
+        // The connection is read-only.
+        CHECK_THROWS(insert(*lease, "n2", "needle two"));
+    }
+    CHECK(pool.acquire()->search_tasks("needle", 10, 0).size() == 1);
+}
+
+// search goes through the pool and sees every acknowledged write, while
+// other threads create tasks beside it.
+void service_searches_through_the_pool() {
+    check::TempDb file("pool_service");
+    Database db(file.path());
+    TaskServiceConfig config;
+    config.read_connections = 2;
+    TaskService service(db, config);
+
+    CHECK(service.read_pool_stats() && service.read_pool_stats()->size == 2);
+
+    const std::string id = service.create_with_parent_id(
+        "ROOT", "needle", "", TaskStatus::TODO, TaskPriority::LOW)->get_id();
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 0; !done; ++i) {
+            service.create_with_parent_id("ROOT", "noise " + std::to_string(i), "",
+                                          TaskStatus::TODO, TaskPriority::LOW);
+        }
+    });
+    std::vector<std::thread> readers;
+    std::atomic<int> misses{0};
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            for (int i = 0; i < 50; ++i) {
+                const auto results = service.search("needle", 10);
+                misses += results.size() == 1 && results[0].task->get_id() == id ? 0 : 1;
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    done = true;
+    writer.join();
+    CHECK(misses == 0);
+
+    // A write acknowledged under WAL_COMMITTED is visible to the next search.
+    service.create_with_parent_id("ROOT", "needle two", "", TaskStatus::TODO,
+                                  TaskPriority::LOW);
+    CHECK(service.search("needle", 10).size() == 2);
+
+    const ReadConnectionPool::Stats stats = *service.read_pool_stats();
+    CHECK(stats.acquired == 201);
+    CHECK(stats.in_use == 0);
+}
+
+void memory_database_has_no_pool() {
+    Database db(":memory:");
+    TaskServiceConfig config;
+    config.read_connections = 2;
+    TaskService service(db, config);
+
+    CHECK(!service.read_pool_stats());
+    service.create_with_parent_id("ROOT", "needle", "", TaskStatus::TODO, TaskPriority::LOW);
+    CHECK(service.search("needle", 10).size() == 1);
+}
+
+} // namespace
+
+int main() {
+    shareable_paths();
+    leases_wait_for_a_connection();
+    readers_see_commits();
+    service_searches_through_the_pool();
+    memory_database_has_no_pool();
+    return check::result();
+}
@@ -0,0 +1,104 @@
+// task_id_test.cpp
+//
+// TaskId hex form, parsing and text hashing, and the ordering guarantees
+// of generate_ordered within a thread and across threads.
+
+#include "../include/TaskId.hpp"
+#include "Check.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void hex_round_trips() {
+    const TaskId id{0x0123456789abcdefULL};
+    CHECK(id.to_hex() == "0123456789abcdef");
+    CHECK(TaskId::from_hex("0123456789abcdef") == id);
+    CHECK(TaskId::from_hex("0123456789ABCDEF") == id);
+
+    std::string out = "x";
+    id.append_hex(out);
+    CHECK(out == "x0123456789abcdef");
+
+    CHECK(!TaskId::from_hex("ROOT"));
+    CHECK(!TaskId::from_hex("0123456789abcde"));
+    CHECK(!TaskId::from_hex("0123456789abcdef0"));
+    CHECK(!TaskId::from_hex("0123456789abcdeg"));
+
+    const TaskId random = TaskId::generate();
+    CHECK(TaskId::from_hex(random.to_hex()) == random);
+}
+
+void ordered_ids_increase() {
+    const auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    TaskId previous = TaskId::generate_ordered();
+    std::string previous_hex = previous.to_hex();
+    for (int i = 0; i < 100000; ++i) {
+        const TaskId id = TaskId::generate_ordered();
+        const std::string hex = id.to_hex();
+        CHECK(previous < id);
+        CHECK(previous_hex < hex);  // text order is id order
+        previous = id;
+        previous_hex = hex;
+    }
+
+    // Tagged, so above "ROOT" and starting with c-f.
+    CHECK(previous_hex > "ROOT");
+    CHECK(previous_hex[0] >= 'c' && previous_hex[0] <= 'f');
+
+    // The time field holds the current Unix milliseconds.
+    const auto ms = static_cast<long long>(
+        (previous.value() >> (64 - TaskId::kTagBits - TaskId::kTimeBits)) &
+        ((1ULL << TaskId::kTimeBits) - 1));
+    CHECK(ms >= now_ms - 1000 && ms <= now_ms + 60000);
+}
+
+void ordered_ids_are_unique_across_threads() {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 20000;
+
+    std::vector<std::vector<TaskId>> made(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&made, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                made[t].push_back(TaskId::generate_ordered());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<TaskId> all;
+    for (const auto& ids : made) {
+        CHECK(std::is_sorted(ids.begin(), ids.end()));
+        all.insert(ids.begin(), ids.end());
+    }
+    CHECK(all.size() == static_cast<std::size_t>(kThreads * kPerThread));
+}
+
+void hashes_id_text() {
+    const std::string hex = TaskId::generate().to_hex();
+    const std::string copy = hex;
+    CHECK(task_id::hash_text(hex) == task_id::hash_text(copy));
+    CHECK(task_id::hash_text(hex) != task_id::hash_text(TaskId::generate().to_hex()));
+    CHECK(task_id::hash_text("ROOT") == std::hash<std::string_view>{}("ROOT"));
+}
+
+} // namespace
+
+int main() {
+    hex_round_trips();
+    ordered_ids_increase();
+    ordered_ids_are_unique_across_threads();
+    hashes_id_text();
+    return check::result();
+}
@@ -0,0 +1,63 @@
+// task_json_test.cpp
+//
+// task_json::append_string: escaping, well-formed UTF-8 copied through,
+// and ill-formed bytes written as U+FFFD so the output always parses.
+
+#include "../include/TaskJson.hpp"
+#include "Check.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <string_view>
+
+namespace {
+
+const std::string kReplacement = "\xEF\xBF\xBD";
+
+std::string as_json(std::string_view value) {
+    std::string out;
+    task_json::append_string(out, value);
+    return out;
+}
+
+void escapes() {
+    CHECK(as_json("plain") == "\"plain\"");
+    CHECK(as_json("a\"b\\c") == "\"a\\\"b\\\\c\"");
+    CHECK(as_json("\n\t\x01") == "\"\\n\\t\\u0001\"");
+    CHECK(as_json(std::string_view("\0", 1)) == "\"\\u0000\"");
+}
+
+void keeps_valid_utf8() {
+    const std::string text = "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80 \xEF\xBF\xBF \xF4\x8F\xBF\xBF";
+    CHECK(as_json(text) == "\"" + text + "\"");
+    CHECK(nlohmann::json::parse(as_json(text)).get<std::string>() == text);
+}
+
+void replaces_invalid_utf8() {
+    CHECK(as_json("a\x80" "b") == "\"a" + kReplacement + "b\"");
+    CHECK(as_json("\xC0\x80") == "\"" + kReplacement + kReplacement + "\"");  // overlong
+    CHECK(as_json("\xE0\x80\x80") == "\"" + kReplacement + kReplacement + kReplacement + "\"");
+    CHECK(as_json("\xED\xA0\x80") == "\"" + kReplacement + kReplacement + kReplacement + "\"");  // surrogate
+    CHECK(as_json("\xF4\x90\x80\x80").find('\xF4') == std::string::npos);  // above U+10FFFF
+    CHECK(as_json("\xF5") == "\"" + kReplacement + "\"");
+    CHECK(as_json("\xFF") == "\"" + kReplacement + "\"");
+
+    // A truncated sequence loses its lead byte only; what follows is kept.
+    CHECK(as_json("x\xE2\x82") == "\"x" + kReplacement + kReplacement + "\"");
+    CHECK(as_json("\xE2\x82" "\xC3\xA9") == "\"" + kReplacement + kReplacement + "\xC3\xA9\"");
+    CHECK(as_json("\xC3\"") == "\"" + kReplacement + "\\\"\"");
+
+    const std::string mixed = "ok\xC3\xA9\x80\xE2\x82\xAC\xFE\n";
+    CHECK(nlohmann::json::parse(as_json(mixed)).get<std::string>() ==
+          "ok\xC3\xA9" + kReplacement + "\xE2\x82\xAC" + kReplacement + "\n");
+}
+
+} // namespace
+
+int main() {
+    escapes();
+    keeps_valid_utf8();
+    replaces_invalid_utf8();
+    return check::result();
+}
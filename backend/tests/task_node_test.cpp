@@ -0,0 +1,173 @@
+// task_node_test.cpp
+//
+// Subtree rollups kept along the ancestor chain, path resolution through
+// the title index of wide nodes, and the status/priority range checks that
+// guard the arrays they index.
+
+#include "../include/TaskNode.hpp"
+#include "Check.hpp"
+
+#include <string>
+
+namespace {
+
+TaskNode::Ptr make_task(const std::string& id, TaskStatus status, TaskPriority priority,
+                        std::time_t created_at = 1) {
+    return std::make_shared<TaskNode>(id, id, "", status, priority, created_at, created_at);
+}
+
+void rollup_counts_descendants() {
+    auto root = make_task("ROOT", TaskStatus::TODO, TaskPriority::MEDIUM);
+    auto project = make_task("p", TaskStatus::IN_PROGRESS, TaskPriority::HIGH);
+    auto done = make_task("a", TaskStatus::COMPLETED, TaskPriority::LOW, 2);
+    auto blocked = make_task("b", TaskStatus::BLOCKED, TaskPriority::CRITICAL, 3);
+
+    // Children attached before their parent joins the tree carry their
+    // rollup up with it.
+    project->add_child(done);
+    project->add_child(blocked);
+    root->add_child(project);
+
+    const TaskNode::Rollup& r = root->get_rollup();
+    CHECK(r.descendants == 3);
+    CHECK(r.by_status[static_cast<std::size_t>(TaskStatus::COMPLETED)] == 1);
+    CHECK(r.by_status[static_cast<std::size_t>(TaskStatus::BLOCKED)] == 1);
+    CHECK(r.by_status[static_cast<std::size_t>(TaskStatus::IN_PROGRESS)] == 1);
+    CHECK(r.by_priority[static_cast<std::size_t>(TaskPriority::HIGH)] == 1);
+    CHECK(r.max_priority() == TaskPriority::CRITICAL);
+    CHECK(project->get_rollup().descendants == 2);
+    CHECK(project->get_rollup().completion_percent() == 50.0);
+
+    CHECK(!done->get_rollup().max_priority());
+    CHECK(done->get_rollup().completion_percent() == 0.0);
+}
+
+void rollup_follows_updates() {
+    auto root = make_task("ROOT", TaskStatus::TODO, TaskPriority::MEDIUM);
+    auto project = make_task("p", TaskStatus::TODO, TaskPriority::MEDIUM);
+    auto task = make_task("a", TaskStatus::TODO, TaskPriority::MEDIUM, 2);
+    root->add_child(project);
+    project->add_child(task);
+
+    task->set_status(TaskStatus::COMPLETED);
+    task->set_priority(TaskPriority::CRITICAL);
+
+    for (const auto& node : {root, project}) {
+        const TaskNode::Rollup& r = node->get_rollup();
+        CHECK(r.by_status[static_cast<std::size_t>(TaskStatus::TODO)] + 1 ==
+              r.descendants);
+        CHECK(r.by_status[static_cast<std::size_t>(TaskStatus::COMPLETED)] == 1);
+        CHECK(r.by_priority[static_cast<std::size_t>(TaskPriority::CRITICAL)] == 1);
+    }
+    CHECK(project->get_rollup().completion_percent() == 100.0);
+
+    CHECK(root->remove_child_by_id("p"));
+    const TaskNode::Rollup& r = root->get_rollup();
+    CHECK(r.descendants == 0);
+    CHECK(r.by_status == (std::array<std::size_t, 4>{}));
+    CHECK(r.by_priority == (std::array<std::size_t, 4>{}));
+    CHECK(!r.max_priority());
+}
+
+// Removing a child other than the last must still subtract it.
+void rollup_follows_middle_removal() {
+    auto root = make_task("ROOT", TaskStatus::TODO, TaskPriority::MEDIUM);
+    auto project = make_task("p", TaskStatus::TODO, TaskPriority::MEDIUM);
+    root->add_child(project);
+    for (int i = 0; i < 40; ++i) {
+        project->add_child(make_task("t" + std::to_string(i), TaskStatus::BLOCKED,
+                                     TaskPriority::LOW, 10 + i));
+    }
+
+    CHECK(project->remove_child_by_id("t3"));
+    CHECK(!project->remove_child_by_id("t3"));
+    CHECK(project->get_children().size() == 39);
+    CHECK(!project->find_child_by_id("t3"));
+
+    for (const auto& node : {root, project}) {
+        const TaskNode::Rollup& r = node->get_rollup();
+        CHECK(r.by_status[static_cast<std::size_t>(TaskStatus::BLOCKED)] == 39);
+        CHECK(r.by_priority[static_cast<std::size_t>(TaskPriority::LOW)] == 39);
+    }
+    CHECK(project->get_rollup().descendants == 39);
+    CHECK(root->get_rollup().descendants == 40);
+}
+
+// A node past kTitleIndexThreshold children resolves through its title
+// index, which must follow renames and removals of any child.
+void resolve_path_on_wide_nodes() {
+    auto root = make_task("ROOT", TaskStatus::TODO, TaskPriority::MEDIUM);
+    auto project = make_task("proj", TaskStatus::TODO, TaskPriority::MEDIUM);
+    root->add_child(project);
+    const std::size_t wide = TaskNode::kTitleIndexThreshold + 8;
+    for (std::size_t i = 0; i < wide; ++i) {
+        project->add_child(make_task("t" + std::to_string(i), TaskStatus::TODO,
+                                     TaskPriority::LOW, static_cast<std::time_t>(10 + i)));
+    }
+
+    CHECK(resolve_path(root, "/proj/t3") == project->find_child_by_id("t3"));
+    CHECK(resolve_path(root, "/proj/t3/") == project->find_child_by_id("t3"));
+    CHECK(!resolve_path(root, "/proj/missing"));
+
+    // Renamed: found under the new title only.
+    project->find_child_by_id("t4")->set_title("renamed");
+    CHECK(!resolve_path(root, "/proj/t4"));
+    CHECK(resolve_path(root, "/proj/renamed") == project->find_child_by_id("t4"));
+
+    // Duplicate titles resolve to the earliest child.
+    project->find_child_by_id("t9")->set_title("t7");
+    CHECK(resolve_path(root, "/proj/t7") == project->find_child_by_id("t7"));
+
+    // A removed middle child is gone from the index too.
+    CHECK(project->remove_child_by_id("t3"));
+    CHECK(!resolve_path(root, "/proj/t3"));
+    CHECK(project->remove_child_by_id("t7"));
+    CHECK(resolve_path(root, "/proj/t7") == project->find_child_by_id("t9"));
+
+    // Below half the threshold the index is dropped; lookups still work.
+    for (std::size_t i = 10; i < wide; ++i) {
+        project->remove_child_by_id("t" + std::to_string(i));
+    }
+    CHECK(project->get_children().size() < TaskNode::kTitleIndexThreshold / 2);
+    CHECK(resolve_path(root, "/proj/renamed") == project->find_child_by_id("t4"));
+    CHECK(!resolve_path(root, "/proj/t3"));
+    CHECK(resolve_path(root, "/proj/t5") == project->find_child_by_id("t5"));
+}
+
+void children_stay_ordered() {
+    auto root = make_task("ROOT", TaskStatus::TODO, TaskPriority::MEDIUM);
+    root->add_child(make_task("c", TaskStatus::TODO, TaskPriority::MEDIUM, 5));
+    root->add_child(make_task("a", TaskStatus::TODO, TaskPriority::MEDIUM, 1));
+    root->add_child(make_task("b", TaskStatus::TODO, TaskPriority::MEDIUM, 5));
+
+    const auto& children = root->get_children();
+    CHECK(children.size() == 3);
+    CHECK(children[0]->get_id() == "a");
+    CHECK(children[1]->get_id() == "b");
+    CHECK(children[2]->get_id() == "c");
+}
+
+void status_and_priority_ranges() {
+    CHECK(is_valid_status(0));
+    CHECK(is_valid_status(3));
+    CHECK(!is_valid_status(-1));
+    CHECK(!is_valid_status(4));
+    CHECK(!is_valid_status(9));
+
+    CHECK(is_valid_priority(0));
+    CHECK(is_valid_priority(3));
+    CHECK(!is_valid_priority(-1));
+    CHECK(!is_valid_priority(4));
+}
+
+} // namespace
+
+int main() {
+    rollup_counts_descendants();
+    rollup_follows_updates();
+    rollup_follows_middle_removal();
+    resolve_path_on_wide_nodes();
+    children_stay_ordered();
+    status_and_priority_ranges();
+    return check::result();
+}
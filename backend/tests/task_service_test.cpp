@@ -0,0 +1,635 @@
+// task_service_test.cpp
+//
+// TaskService over a real database: input validation, the per-parent
+// status/priority facets behind query_children, cursor pages, detached
+// listings, snapshot reads against the live tree, batch creates, reloads
+// and failed writes.
+
+#include "../include/Database.hpp"
+#include "../include/TaskService.hpp"
+#include "Check.hpp"
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+TaskServiceConfig test_config() {
+    TaskServiceConfig config;
+    config.read_connections = 0;
+    return config;
+}
+
+// Runs `sql` on a second connection.
+void exec_raw(const std::string& path, const char* sql) {
+    sqlite3* db = nullptr;
+    sqlite3_open(path.c_str(), &db);
+    CHECK(sqlite3_exec(db, sql, nullptr, nullptr, nullptr) == SQLITE_OK);
+    sqlite3_close(db);
+}
+
+// Makes SQLite refuse to insert or update a task to the title "boom", and
+// to delete one described as "undeletable", standing in for failing writes.
+void add_failing_triggers(const std::string& path) {
+    exec_raw(path, R"sql(
+        CREATE TRIGGER fail_insert BEFORE INSERT ON tasks WHEN NEW.title = 'boom'
+            BEGIN SELECT RAISE(ABORT, 'boom'); END;
+        CREATE TRIGGER fail_update BEFORE UPDATE ON tasks WHEN NEW.title = 'boom'
+            BEGIN SELECT RAISE(ABORT, 'boom'); END;
+        CREATE TRIGGER fail_delete BEFORE DELETE ON tasks
+            WHEN OLD.description = 'undeletable'
+            BEGIN SELECT RAISE(ABORT, 'boom'); END;
+    )sql");
+}
+
+std::size_t child_count(TaskService& service, const std::string& parent_id) {
+    return service.ls_by_parent_id(parent_id).size();
+}
+
+void rejects_out_of_range_enums() {
+    check::TempDb file("enums");
+    Database db(file.path());
+    TaskService service(db, test_config());
+
+    const auto bad_status = static_cast<TaskStatus>(9);
+    const auto bad_priority = static_cast<TaskPriority>(-1);
+
+    CHECK_THROWS(service.create_with_parent_id("ROOT", "t", "", bad_status,
+                                               TaskPriority::LOW));
+    CHECK_THROWS(service.create_with_parent_id("ROOT", "t", "", TaskStatus::TODO,
+                                               bad_priority));
+    CHECK(child_count(service, "ROOT") == 0);
+
+    // A bad draft deep in a batch rejects the whole batch up front.
+    std::vector<TaskDraft> drafts(2);
+    drafts[0].title = "a";
+    drafts[1].title = "b";
+    drafts[1].children.resize(1);
+    drafts[1].children[0].title = "c";
+    drafts[1].children[0].priority = bad_priority;
+    CHECK_THROWS(service.create_batch("ROOT", drafts));
+    CHECK(child_count(service, "ROOT") == 0);
+
+    const TaskNode::Ptr task = service.create_with_parent_id(
+        "ROOT", "t", "", TaskStatus::TODO, TaskPriority::LOW);
+    CHECK_THROWS(service.modify(task->get_id(), std::nullopt, std::nullopt,
+                                bad_status, std::nullopt));
+    CHECK(task->get_status() == TaskStatus::TODO);
+
+    TaskQuery query;
+    query.statuses = {bad_status};
+    CHECK_THROWS(service.query_children("ROOT", query));
+    query.statuses.clear();
+    query.priorities = {static_cast<TaskPriority>(4)};
+    CHECK_THROWS(service.query_children("ROOT", query));
+}
+
+void facets_follow_modify() {
+    check::TempDb file("facets");
+    Database db(file.path());
+    TaskService service(db, test_config());
+
+    const auto a = service.create_with_parent_id("ROOT", "a", "", TaskStatus::TODO,
+                                                 TaskPriority::HIGH);
+    const auto b = service.create_with_parent_id("ROOT", "b", "", TaskStatus::BLOCKED,
+                                                 TaskPriority::LOW);
+    service.create_with_parent_id("ROOT", "c", "", TaskStatus::TODO, TaskPriority::LOW);
+
+    TaskQuery todo;
+    todo.statuses = {TaskStatus::TODO};
+    CHECK(service.query_children("ROOT", todo).matched == 2);
+
+    TaskQuery todo_low = todo;
+    todo_low.priorities = {TaskPriority::LOW};
+    CHECK(service.query_children("ROOT", todo_low).matched == 1);
+
+    CHECK(service.modify(b->get_id(), std::nullopt, std::nullopt, TaskStatus::TODO,
+                         std::nullopt));
+    CHECK(service.query_children("ROOT", todo).matched == 3);
+    CHECK(service.query_children("ROOT", todo_low).matched == 2);
+
+    CHECK(service.delete_subtree(a->get_id()));
+    CHECK(service.query_children("ROOT", todo).matched == 2);
+
+    // Repeated filter values list each row once.
+    TaskQuery repeated;
+    repeated.statuses = {TaskStatus::TODO, TaskStatus::TODO};
+    CHECK(service.query_children("ROOT", repeated).items.size() == 2);
+}
+
+// Deleting a middle sibling updates the rollups the listing reports, the
+// same as a reload from the database does.
+void rollups_follow_middle_delete(bool snapshot_reads) {
+    check::TempDb file("middle");
+    TaskServiceConfig config = test_config();
+    config.snapshot_reads = snapshot_reads;
+
+    std::string project;
+    {
+        Database db(file.path());
+        TaskService service(db, config);
+        project = service.create_with_parent_id("ROOT", "proj", "", TaskStatus::TODO,
+                                                TaskPriority::LOW)->get_id();
+        std::vector<std::string> ids;
+        for (int i = 0; i < 40; ++i) {
+            ids.push_back(service.create_with_parent_id(
+                project, "t" + std::to_string(i), "", TaskStatus::BLOCKED,
+                TaskPriority::LOW)->get_id());
+        }
+        CHECK(service.delete_subtree(ids[3]));
+
+        const auto listing = service.ls_by_parent_id("ROOT");
+        CHECK(listing.size() == 1);
+        CHECK(listing[0]->get_rollup().descendants == 39);
+        CHECK(listing[0]->get_rollup().by_status[
+                  static_cast<std::size_t>(TaskStatus::BLOCKED)] == 39);
+        CHECK(service.ls_by_parent_id(project).size() == 39);
+    }
+
+    Database db(file.path());
+    TaskService reloaded(db, config);
+    CHECK(reloaded.ls_by_parent_id("ROOT")[0]->get_rollup().descendants == 39);
+}
+
+// Paths stop resolving to a deleted middle child of a wide node.
+void deleted_children_leave_paths() {
+    check::TempDb file("paths");
+    Database db(file.path());
+    TaskService service(db, test_config());
+
+    service.create("/", "proj");
+    for (int i = 0; i < 40; ++i) {
+        service.create("/proj", "t" + std::to_string(i));
+    }
+    const auto doomed = service.find("/proj/t3");
+    CHECK(doomed != nullptr);
+    CHECK(service.delete_subtree(doomed->get_id()));
+
+    CHECK(service.find("/proj/t3") == nullptr);
+    CHECK_THROWS(service.create("/proj/t3", "child"));
+    CHECK(service.find("/proj/t4") != nullptr);
+}
+
+void cursors_round_trip() {
+    const ChildCursor cursor{1700000000, "c0ffee0123456789"};
+    const std::string token = cursor.encode();
+    const auto decoded = ChildCursor::decode(token);
+    CHECK(decoded && decoded->created_at == cursor.created_at && decoded->id == cursor.id);
+    CHECK(token.find_first_not_of("0123456789abcdef") == std::string::npos);
+
+    CHECK(!ChildCursor::decode(""));
+    CHECK(!ChildCursor::decode(token.substr(1)));            // odd length
+    CHECK(!ChildCursor::decode("zz" + token));               // not hex
+    CHECK(!ChildCursor::decode(ChildCursor{0, ""}.encode())); // no id
+    CHECK(!ChildCursor::decode("3132333435"));               // no separator
+}
+
+// Pages are stable while siblings are added and removed around the cursor.
+void pages_follow_the_cursor() {
+    check::TempDb file("pages");
+    Database db(file.path());
+    TaskService service(db, test_config());
+
+    std::vector<std::string> ids;
+    for (int i = 0; i < 5; ++i) {
+        ids.push_back(service.create_with_parent_id(
+            "ROOT", "t" + std::to_string(i), "", TaskStatus::TODO, TaskPriority::LOW)->get_id());
+    }
+
+    ChildPage first = service.ls_page("ROOT", std::nullopt, 2);
+    CHECK(first.items.size() == 2 && first.items[1]->get_id() == ids[1]);
+    CHECK(first.next.has_value());
+
+    // The last row of the page goes away; the next page starts after it.
+    CHECK(service.delete_subtree(ids[1]));
+    const ChildPage second = service.ls_page("ROOT", ChildCursor::decode(first.next->encode()), 2);
+    CHECK(second.items.size() == 2 && second.items[0]->get_id() == ids[2] &&
+          second.items[1]->get_id() == ids[3]);
+
+    // Added after the cursor, so it shows up on a later page.
+    const std::string added = service.create_with_parent_id(
+        "ROOT", "added", "", TaskStatus::TODO, TaskPriority::LOW)->get_id();
+    const ChildPage last = service.ls_page("ROOT", second.next, 10);
+    CHECK(last.items.size() == 2 && last.items[0]->get_id() == ids[4] &&
+          last.items[1]->get_id() == added);
+    CHECK(!last.next.has_value());
+}
+
+void ls_subtree_walks_levels(bool snapshot_reads) {
+    check::TempDb file("subtree");
+    Database db(file.path());
+    TaskServiceConfig config = test_config();
+    config.snapshot_reads = snapshot_reads;
+    TaskService service(db, config);
+
+    auto make = [&](const std::string& parent, const char* title) {
+        return service.create_with_parent_id(parent, title, "", TaskStatus::TODO,
+                                             TaskPriority::LOW)->get_id();
+    };
+    const std::string a = make("ROOT", "a");
+    const std::string b = make("ROOT", "b");
+    const std::string a1 = make(a, "a1");
+    make(a1, "a11");
+    make(a, "a2");
+
+    const auto one = service.ls_subtree("ROOT", 0, 100);  // depth 0 means 1
+    CHECK(one && one->node_count == 2 && !one->truncated);
+    CHECK(one && one->children[0].node->get_id() == a);
+    CHECK(one && one->children[0].has_children && !one->children[0].expanded);
+    CHECK(one && one->children[0].children.empty());
+    CHECK(one && !one->children[1].has_children);
+
+    const auto two = service.ls_subtree("ROOT", 2, 100);
+    CHECK(two && two->node_count == 4);
+    CHECK(two && two->children[0].expanded && two->children[0].children.size() == 2);
+    const TaskSubtree* first = two ? &two->children[0].children[0] : nullptr;
+    CHECK(first && first->node->get_id() == a1 && first->has_children && !first->expanded);
+
+    const auto three = service.ls_subtree("ROOT", 3, 100);
+    CHECK(three && three->node_count == 5 && !three->truncated);
+    CHECK(three && three->children[0].children[0].expanded);
+
+    // Breadth-first: the limit keeps the upper levels.
+    const auto cut = service.ls_subtree("ROOT", 3, 3);
+    CHECK(cut && cut->truncated && cut->node_count == 3);
+    CHECK(cut && cut->children.size() == 2 && cut->children[0].children.size() == 1);
+
+    const auto below = service.ls_subtree(a, 1, 100);
+    CHECK(below && below->node_count == 2);
+
+    const auto unknown = service.ls_subtree("missing", 2, 100);
+    CHECK(snapshot_reads ? unknown && unknown->node_count == 0 : !unknown);
+
+    // The listing holds copies.
+    CHECK(service.modify(a, std::string("renamed"), std::nullopt, std::nullopt,
+                         std::nullopt));
+    CHECK(three && three->children[0].node->get_title() == "a");
+    CHECK(service.ls_subtree("ROOT", 1, 100)->children[0].node->get_title() == "renamed");
+    CHECK(service.ls_subtree("ROOT", 1, 100)->children[1].node->get_id() == b);
+}
+
+// Listings outlive the lock, so later writes must not show through them.
+void listings_are_detached() {
+    check::TempDb file("detached");
+    Database db(file.path());
+    TaskService service(db, test_config());
+
+    const std::string id = service.create_with_parent_id(
+        "ROOT", "old", "", TaskStatus::TODO, TaskPriority::LOW)->get_id();
+    const auto listing = service.ls_by_parent_id("ROOT");
+    const auto page = service.ls_page("ROOT", std::nullopt, 10);
+    TaskQuery todo;
+    todo.statuses = {TaskStatus::TODO};
+    const auto queried = service.query_children("ROOT", todo);
+    const auto all = service.query_children("ROOT", TaskQuery{});
+
+    CHECK(service.modify(id, std::string("new"), std::nullopt, TaskStatus::COMPLETED,
+                         std::nullopt));
+    CHECK(listing.size() == 1 && listing[0]->get_title() == "old");
+    CHECK(listing[0]->get_status() == TaskStatus::TODO);
+    CHECK(page.items.size() == 1 && page.items[0]->get_title() == "old");
+    CHECK(queried.items.size() == 1 && queried.items[0]->get_title() == "old");
+    CHECK(queried.items[0]->get_status() == TaskStatus::TODO);
+    CHECK(all.items.size() == 1 && all.items[0]->get_title() == "old");
+    CHECK(service.ls_by_parent_id("ROOT")[0]->get_title() == "new");
+}
+
+// Without read connections, search shares the writer's connection with
+// the journal; its results are copies like the listings'.
+void search_without_read_connections() {
+    check::TempDb file("search");
+    Database db(file.path());
+    TaskServiceConfig config = test_config();
+    config.durability = Durability::IN_MEMORY;
+    TaskService service(db, config);
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 0; !done; ++i) {
+            service.create_with_parent_id("ROOT", "noise " + std::to_string(i), "",
+                                          TaskStatus::TODO, TaskPriority::LOW);
+        }
+    });
+    const std::string id = service.create_with_parent_id(
+        "ROOT", "needle", "", TaskStatus::TODO, TaskPriority::LOW)->get_id();
+    service.sync();
+    for (int i = 0; i < 50; ++i) {
+        const auto results = service.search("needle", 10);
+        CHECK(results.size() == 1 && results[0].task->get_id() == id);
+    }
+    done = true;
+    writer.join();
+
+    const auto results = service.search("needle", 10);
+    CHECK(service.modify(id, std::string("renamed"), std::nullopt, std::nullopt,
+                         std::nullopt));
+    CHECK(results.size() == 1 && results[0].task->get_title() == "needle");
+    CHECK(results.size() == 1 && results[0].path == "/needle/");
+}
+
+// A copy handed out by a read path shows the same task as the live node.
+bool same_task(const TaskNode& copy, const TaskNode& live) {
+    const auto& a = copy.get_rollup();
+    const auto& b = live.get_rollup();
+    return copy.get_id() == live.get_id() && copy.get_title() == live.get_title() &&
+           copy.get_description() == live.get_description() &&
+           copy.get_status() == live.get_status() &&
+           copy.get_priority() == live.get_priority() &&
+           copy.get_updated_at() == live.get_updated_at() &&
+           a.descendants == b.descendants && a.by_status == b.by_status &&
+           a.by_priority == b.by_priority;
+}
+
+// Checks every read path over the children of `node`, and of everything
+// below it, against the live tree.
+void check_reads_match(TaskService& service, const TaskNode& node) {
+    const std::string& id = node.get_id();
+    const auto& live = node.get_children();
+
+    const auto listing = service.ls_by_parent_id(id);
+    CHECK(listing.size() == live.size());
+    for (std::size_t i = 0; i < listing.size() && i < live.size(); ++i) {
+        CHECK(same_task(*listing[i], *live[i]));
+    }
+
+    std::size_t paged = 0;
+    std::optional<ChildCursor> after;
+    do {
+        const ChildPage page = service.ls_page(id, after, 2);
+        for (const auto& item : page.items) {
+            CHECK(paged < live.size() && same_task(*item, *live[paged]));
+            ++paged;
+        }
+        after = page.next;
+    } while (after);
+    CHECK(paged == live.size());
+
+    const auto all = service.query_children(id, TaskQuery{});
+    CHECK(all.matched == live.size() && all.items.size() == live.size());
+    for (std::size_t i = 0; i < all.items.size() && i < live.size(); ++i) {
+        CHECK(same_task(*all.items[i], *live[i]));
+    }
+    TaskQuery completed;
+    completed.statuses = {TaskStatus::COMPLETED};
+    std::size_t live_completed = 0;
+    for (const auto& child : live) {
+        live_completed += child->get_status() == TaskStatus::COMPLETED ? 1 : 0;
+    }
+    CHECK(service.query_children(id, completed).matched == live_completed);
+
+    const auto subtree = service.ls_subtree(id, 1, 1000);
+    CHECK(subtree && subtree->children.size() == live.size());
+    for (std::size_t i = 0; subtree && i < subtree->children.size() && i < live.size(); ++i) {
+        CHECK(same_task(*subtree->children[i].node, *live[i]));
+        CHECK(subtree->children[i].has_children == !live[i]->get_children().empty());
+    }
+
+    for (const auto& child : live) {
+        check_reads_match(service, *child);
+    }
+}
+
+// In snapshot mode the published listings follow every kind of change to
+// the live tree: creates, modifies, deletes and resyncs after failed or
+// outside writes.
+void snapshot_reads_match_live_tree() {
+    check::TempDb file("snapshot");
+    {
+        Database db(file.path());
+        db.open();
+        db.ensure_root();
+    }
+    add_failing_triggers(file.path());
+
+    Database db(file.path());
+    TaskServiceConfig config = test_config();
+    config.snapshot_reads = true;
+    TaskService service(db, config);
+    const auto check_all = [&] { check_reads_match(service, *service.workspace()); };
+
+    std::vector<std::string> ids;
+    for (int i = 0; i < 5; ++i) {
+        ids.push_back(service.create_with_parent_id(
+            "ROOT", "top" + std::to_string(i), "", TaskStatus::TODO,
+            TaskPriority::LOW)->get_id());
+    }
+    for (int i = 0; i < 3; ++i) {
+        service.create_with_parent_id(ids[1], "mid" + std::to_string(i), "",
+                                      TaskStatus::IN_PROGRESS, TaskPriority::HIGH);
+    }
+    const std::string deep = service.create_with_parent_id(
+        ids[2], "deep", "", TaskStatus::TODO, TaskPriority::MEDIUM)->get_id();
+    std::vector<TaskDraft> drafts(1);
+    drafts[0].title = "batch";
+    drafts[0].children.resize(2);
+    drafts[0].children[0].title = "batch child";
+    drafts[0].children[1].title = "batch child 2";
+    service.create_batch(deep, drafts);
+    check_all();
+
+    CHECK(service.modify(deep, std::string("renamed"), std::nullopt, TaskStatus::COMPLETED,
+                         TaskPriority::CRITICAL));
+    CHECK(service.modify(ids[0], std::nullopt, std::string("described"),
+                         TaskStatus::COMPLETED, std::nullopt));
+    check_all();
+
+    CHECK(service.delete_subtree(ids[1]));
+    CHECK(service.delete_subtree(ids[3]));
+    check_all();
+
+    // Failed writes resync the tree, and the snapshot with it.
+    CHECK_THROWS(service.modify(ids[2], std::string("boom"), std::nullopt,
+                                TaskStatus::BLOCKED, std::nullopt));
+    CHECK_THROWS(service.create_with_parent_id(deep, "boom", "", TaskStatus::TODO,
+                                               TaskPriority::LOW));
+    check_all();
+
+    // So does a reload that picks up writes made outside the service.
+    exec_raw(file.path(),
+             ("UPDATE tasks SET title = 'outside', status = 2 WHERE id = '" + ids[4] +
+              "';").c_str());
+    service.init();
+    CHECK(service.find_by_id(ids[4])->get_title() == "outside");
+    check_all();
+}
+
+TaskDraft draft(std::string title, std::vector<TaskDraft> children = {}) {
+    TaskDraft out;
+    out.title = std::move(title);
+    out.children = std::move(children);
+    return out;
+}
+
+// create_batch returns parents before their children, writes the whole
+// import as one journal job, and the result survives a reload. A draft the
+// database rejects takes the rest of its batch with it.
+void create_batch_is_one_job() {
+    check::TempDb file("batch");
+    {
+        Database db(file.path());
+        db.open();
+        db.ensure_root();
+    }
+    add_failing_triggers(file.path());
+
+    const std::vector<TaskDraft> drafts{
+        draft("a", {draft("a1", {draft("a11"), draft("a12")}), draft("a2")}),
+        draft("b", {draft("b1")}),
+    };
+
+    std::string parent_id;
+    {
+        Database db(file.path());
+        TaskService service(db, test_config());
+        parent_id = service.create_with_parent_id(
+            "ROOT", "import", "", TaskStatus::TODO, TaskPriority::LOW)->get_id();
+
+        const auto before = service.journal_stats().submitted;
+        const auto created = service.create_batch(parent_id, drafts);
+        CHECK(service.journal_stats().submitted == before + 1);
+        CHECK(created.size() == 7);
+
+        std::set<std::string> seen{parent_id};
+        for (const auto& node : created) {
+            const TaskNode::Ptr live = service.find_by_id(node->get_id());
+            CHECK(live && seen.count(live->get_parent()->get_id()) == 1);
+            seen.insert(node->get_id());
+        }
+        CHECK(created[0]->get_title() == "a");
+        CHECK(created[0]->get_rollup().descendants == 4);
+
+        // "boom" is refused by SQLite, so none of this batch is kept.
+        const std::vector<TaskDraft> doomed{draft("c", {draft("c1", {draft("boom")})})};
+        CHECK_THROWS(service.create_batch(parent_id, doomed));
+        CHECK(service.find("/import/c/") == nullptr);
+        CHECK(child_count(service, parent_id) == 2);
+    }
+
+    Database db(file.path());
+    TaskService service(db, test_config());
+    CHECK(service.find("/import/a/a1/a12") != nullptr);
+    CHECK(service.find("/import/a/a2") != nullptr);
+    CHECK(service.find("/import/b/b1") != nullptr);
+    CHECK(service.find("/import/c") == nullptr);
+    CHECK(service.find_by_id(parent_id)->get_rollup().descendants == 7);
+}
+
+// init() reloads from the database while readers look tasks up.
+void init_reloads_beside_readers() {
+    check::TempDb file("init");
+    Database db(file.path());
+    TaskService service(db, test_config());
+
+    const auto task = service.create_with_parent_id("ROOT", "before", "", TaskStatus::TODO,
+                                                    TaskPriority::LOW);
+    const std::string id = task->get_id();
+    exec_raw(file.path(), ("UPDATE tasks SET title = 'after' WHERE id = '" + id + "';").c_str());
+
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::thread reader([&] {
+        while (!done) {
+            const auto node = service.find_by_id(id);
+            misses += node ? 0 : 1;
+            misses += service.ls_by_parent_id("ROOT").size() == 1 ? 0 : 1;
+        }
+    });
+    for (int i = 0; i < 20; ++i) {
+        service.init();
+    }
+    done = true;
+    reader.join();
+
+    CHECK(misses == 0);
+    CHECK(service.find_by_id(id)->get_title() == "after");
+    CHECK(service.find_by_id("missing") == nullptr);
+}
+
+void failed_writes_are_undone(Durability durability) {
+    check::TempDb file("failed_writes");
+    {
+        // Creates the schema so the triggers have a table to attach to.
+        Database db(file.path());
+        db.open();
+        db.ensure_root();
+    }
+    add_failing_triggers(file.path());
+
+    Database db(file.path());
+    TaskServiceConfig config = test_config();
+    config.durability = durability;
+    TaskService service(db, config);
+
+    const auto settle = [&](auto&& mutate) {
+        if (durability == Durability::WAL_COMMITTED) {
+            CHECK_THROWS(mutate());
+        } else {
+            mutate();
+            service.sync();
+        }
+    };
+
+    // A rejected INSERT must not leave a ghost node behind.
+    settle([&] {
+        service.create_with_parent_id("ROOT", "boom", "", TaskStatus::TODO,
+                                      TaskPriority::LOW);
+    });
+    CHECK(child_count(service, "ROOT") == 0);
+    CHECK(service.workspace()->get_rollup().descendants == 0);
+
+    // A rejected UPDATE restores the old fields and facets.
+    const std::string id = service.create_with_parent_id(
+        "ROOT", "kept", "", TaskStatus::TODO, TaskPriority::LOW)->get_id();
+    settle([&] {
+        service.modify(id, std::string("boom"), std::nullopt, TaskStatus::COMPLETED,
+                       std::nullopt);
+    });
+    auto listing = service.ls_by_parent_id("ROOT");
+    CHECK(listing.size() == 1 && listing[0]->get_title() == "kept");
+    TaskQuery completed;
+    completed.statuses = {TaskStatus::COMPLETED};
+    CHECK(service.query_children("ROOT", completed).matched == 0);
+
+    // A rejected DELETE brings the subtree back.
+    const std::string doomed = service.create_with_parent_id(
+        "ROOT", "parent", "undeletable", TaskStatus::TODO, TaskPriority::LOW)->get_id();
+    service.create_with_parent_id(doomed, "child", "", TaskStatus::TODO, TaskPriority::LOW);
+    settle([&] { service.delete_subtree(doomed); });
+    CHECK(child_count(service, "ROOT") == 2);
+    CHECK(child_count(service, doomed) == 1);
+    CHECK(service.workspace()->get_rollup().descendants == 3);
+
+    // Writes keep working afterwards.
+    service.create_with_parent_id("ROOT", "after", "", TaskStatus::TODO, TaskPriority::LOW);
+    service.sync();
+    CHECK(child_count(service, "ROOT") == 3);
+    CHECK(service.journal_stats().failed == 3);
+}
+
+} // namespace
+
+int main() {
+    rejects_out_of_range_enums();
+    facets_follow_modify();
+    rollups_follow_middle_delete(false);
+    rollups_follow_middle_delete(true);
+    deleted_children_leave_paths();
+    cursors_round_trip();
+    pages_follow_the_cursor();
+    ls_subtree_walks_levels(false);
+    ls_subtree_walks_levels(true);
+    listings_are_detached();
+    search_without_read_connections();
+    snapshot_reads_match_live_tree();
+    create_batch_is_one_job();
+    init_reloads_beside_readers();
+    failed_writes_are_undone(Durability::WAL_COMMITTED);
+    failed_writes_are_undone(Durability::IN_MEMORY);
+    return check::result();
+}
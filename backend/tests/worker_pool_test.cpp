@@ -0,0 +1,136 @@
+// worker_pool_test.cpp
+//
+// WorkerPool: jobs beyond max_queued are marked for shedding and run
+// first, jobs past the shed allowance are rejected, queue waits are
+// reported once per connection, and shutdown drains what is queued.
+
+#include "../include/WorkerPool.hpp"
+#include "Check.hpp"
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// Occupies one worker until release() is called.
+class Gate {
+public:
+    explicit Gate(WorkerPool& pool) {
+        auto released = release_.get_future().share();
+        CHECK(pool.enqueue([this, released] {
+            running_.set_value();
+            released.wait();
+        }));
+        running_.get_future().wait();
+    }
+
+    void release() { release_.set_value(); }
+
+private:
+    std::promise<void> running_;
+    std::promise<void> release_;
+};
+
+struct Ran {
+    std::string name;
+    bool shed;
+    bool shed_again;
+    std::chrono::steady_clock::duration waited;
+    std::chrono::steady_clock::duration waited_again;
+};
+
+void sheds_past_the_bound() {
+    std::mutex mutex;
+    std::vector<Ran> ran;
+    std::atomic<int> ended{0};
+    WorkerPool pool(1, 2, [&] { ++ended; });
+
+    const auto job = [&](std::string name) {
+        return [&, name] {
+            Ran r{name, WorkerPool::take_shed_flag(), WorkerPool::take_shed_flag(),
+                  WorkerPool::take_queue_wait(), WorkerPool::take_queue_wait()};
+            std::lock_guard lock(mutex);
+            ran.push_back(r);
+        };
+    };
+
+    Gate gate(pool);
+    CHECK(pool.enqueue(job("queued 1")));
+    CHECK(pool.enqueue(job("queued 2")));
+    CHECK(pool.enqueue(job("shed 1")));
+    CHECK(pool.enqueue(job("shed 2")));
+    CHECK(!pool.enqueue(job("rejected")));
+    std::this_thread::sleep_for(5ms);
+    gate.release();
+    pool.shutdown();
+
+    CHECK(ran.size() == 4);
+    CHECK(ended == 5);
+    if (ran.size() == 4) {
+        // Shed connections jump the queue.
+        CHECK(ran[0].name == "shed 1" && ran[1].name == "shed 2");
+        CHECK(ran[2].name == "queued 1" && ran[3].name == "queued 2");
+        for (std::size_t i = 0; i < ran.size(); ++i) {
+            CHECK(ran[i].shed == (i < 2));
+            CHECK(!ran[i].shed_again);
+            CHECK(ran[i].waited >= 5ms);
+            CHECK(ran[i].waited_again == std::chrono::steady_clock::duration::zero());
+        }
+    }
+}
+
+void unbounded_queue() {
+    std::atomic<int> ran{0};
+    std::atomic<int> shed{0};
+    WorkerPool pool(2, 0);
+    Gate first(pool);
+    Gate second(pool);
+    for (int i = 0; i < 100; ++i) {
+        CHECK(pool.enqueue([&] {
+            ++ran;
+            shed += WorkerPool::take_shed_flag() ? 1 : 0;
+        }));
+    }
+    first.release();
+    second.release();
+    pool.shutdown();
+    CHECK(ran == 100);
+    CHECK(shed == 0);
+}
+
+void shutdown_drains_and_refuses() {
+    std::atomic<int> ran{0};
+    WorkerPool pool(3, 16);
+    for (int i = 0; i < 10; ++i) {
+        CHECK(pool.enqueue([&] {
+            std::this_thread::sleep_for(1ms);
+            ++ran;
+        }));
+    }
+    pool.shutdown();
+    CHECK(ran == 10);
+    CHECK(!pool.enqueue([&] { ++ran; }));
+    pool.shutdown();  // a second call is harmless
+    CHECK(ran == 10);
+
+    // Outside a worker there is nothing to take.
+    CHECK(!WorkerPool::take_shed_flag());
+    CHECK(WorkerPool::take_queue_wait() == std::chrono::steady_clock::duration::zero());
+
+    CHECK_THROWS(WorkerPool(0, 1));
+}
+
+} // namespace
+
+int main() {
+    sheds_past_the_bound();
+    unbounded_queue();
+    shutdown_drains_and_refuses();
+    return check::result();
+}
@@ -0,0 +1,194 @@
+// write_journal_test.cpp
+//
+// WriteJournal group commit: queued jobs share one transaction up to
+// max_batch, the batch window collects late jobs, and a failing job is
+// rolled back to its own savepoint while the rest of its batch commits.
+
+#include "../include/Database.hpp"
+#include "../include/WriteJournal.hpp"
+#include "Check.hpp"
+
+#include <future>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+void open_db(Database& db) {
+    db.open();
+    db.ensure_root();
+}
+
+WriteJournal::Job insert_job(const std::string& id) {
+    return [id](Database& db) {
+        db.insert_task(TaskNode(id, "title " + id, "", TaskStatus::TODO,
+                                TaskPriority::MEDIUM, 1, 1),
+                       "ROOT");
+    };
+}
+
+// Ids of the tasks under ROOT as stored.
+std::set<std::string> stored_ids(const std::string& path) {
+    Database db(path);
+    open_db(db);
+    const TaskNode::Ptr root = db.load_tree("ROOT");
+    std::set<std::string> ids;
+    for (const auto& child : root->get_children()) {
+        ids.insert(child->get_id());
+    }
+    return ids;
+}
+
+// Occupies the writer thread until release() is called, so that jobs
+// submitted meanwhile queue up behind it.
+class WriterGate {
+public:
+    explicit WriterGate(WriteJournal& journal) {
+        auto released = release_.get_future().share();
+        done_ = journal.submit([this, released](Database&) {
+            running_.set_value();
+            released.wait();
+        });
+        running_.get_future().wait();
+    }
+
+    void release() {
+        release_.set_value();
+        done_.get();
+    }
+
+private:
+    std::promise<void> running_;
+    std::promise<void> release_;
+    std::future<void> done_;
+};
+
+void queued_jobs_share_a_transaction() {
+    check::TempDb file("journal_batch");
+    Database db(file.path());
+    open_db(db);
+    {
+        WriteJournal journal(db, WriteJournalConfig{});
+        WriterGate gate(journal);
+
+        std::vector<std::future<void>> written;
+        for (int i = 0; i < 5; ++i) {
+            written.push_back(journal.submit(insert_job("t" + std::to_string(i))));
+        }
+        CHECK(journal.stats().depth == 5);
+        gate.release();
+        for (auto& done : written) {
+            done.get();
+        }
+        journal.flush();
+
+        const WriteJournal::Stats stats = journal.stats();
+        CHECK(stats.batches == 2);      // the gate, then all five together
+        CHECK(stats.max_batch == 5);
+        CHECK(stats.completed == 6);
+        CHECK(stats.failed == 0);
+        CHECK(stats.max_depth == 5);
+    }
+    CHECK(stored_ids(file.path()).size() == 5);
+}
+
+void batches_stop_at_max_batch() {
+    check::TempDb file("journal_max_batch");
+    Database db(file.path());
+    open_db(db);
+
+    WriteJournalConfig config;
+    config.max_batch = 2;
+    WriteJournal journal(db, config);
+    WriterGate gate(journal);
+    for (int i = 0; i < 5; ++i) {
+        journal.submit(insert_job("t" + std::to_string(i)));
+    }
+    gate.release();
+    journal.flush();
+
+    const WriteJournal::Stats stats = journal.stats();
+    CHECK(stats.batches == 4);          // the gate, then 2 + 2 + 1
+    CHECK(stats.max_batch == 2);
+    CHECK(stats.completed == 6);
+}
+
+void window_collects_late_jobs() {
+    check::TempDb file("journal_window");
+    Database db(file.path());
+    open_db(db);
+
+    WriteJournalConfig config;
+    config.batch_window = 2s;
+    config.max_batch = 3;
+    WriteJournal journal(db, config);
+
+    // The batch closes once it is full, long before the window ends.
+    const auto start = std::chrono::steady_clock::now();
+    auto first = journal.submit(insert_job("a"));
+    std::this_thread::sleep_for(20ms);
+    auto second = journal.submit(insert_job("b"));
+    std::this_thread::sleep_for(20ms);
+    auto third = journal.submit(insert_job("c"));
+    first.get();
+    second.get();
+    third.get();
+    CHECK(std::chrono::steady_clock::now() - start < 1s);
+    journal.flush();  // batch counters move after the futures are settled
+
+    const WriteJournal::Stats stats = journal.stats();
+    CHECK(stats.batches == 1);
+    CHECK(stats.max_batch == 3);
+}
+
+void failing_job_rolls_back_alone() {
+    check::TempDb file("journal_failure");
+    Database db(file.path());
+    open_db(db);
+    {
+        WriteJournal journal(db, WriteJournalConfig{});
+        WriterGate gate(journal);
+
+        auto a = journal.submit(insert_job("a"));
+        // Writes its row, then fails: the row must not survive.
+        auto thrown = journal.submit([](Database& db) {
+            insert_job("thrown")(db);
+            throw std::runtime_error("[ERROR] job failed");
+        });
+        auto b = journal.submit(insert_job("b"));
+        // Fails inside SQLite: "a" already exists.
+        auto duplicate = journal.submit(insert_job("a"));
+        auto c = journal.submit(insert_job("c"));
+
+        gate.release();
+        a.get();
+        b.get();
+        c.get();
+        CHECK_THROWS(thrown.get());
+        CHECK_THROWS(duplicate.get());
+        journal.flush();
+
+        const WriteJournal::Stats stats = journal.stats();
+        CHECK(stats.batches == 2);
+        CHECK(stats.max_batch == 5);
+        CHECK(stats.completed == 4);
+        CHECK(stats.failed == 2);
+        CHECK(journal.failed_jobs() == 2);
+    }
+    CHECK((stored_ids(file.path()) == std::set<std::string>{"a", "b", "c"}));
+}
+
+} // namespace
+
+int main() {
+    queued_jobs_share_a_transaction();
+    batches_stop_at_max_batch();
+    window_collects_late_jobs();
+    failing_job_rolls_back_alone();
+    return check::result();
+}
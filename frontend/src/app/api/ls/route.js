@@ -1,5 +1,14 @@
 import { NextResponse } from "next/server";
 
+const LIST_PARAMS = [
+  "limit",
+  "cursor",
+  "status",
+  "priority",
+  "updated_since",
+  "sort",
+];
+
 export async function GET(req) {
   const { searchParams } = new URL(req.url);
   const parentId = searchParams.get("parent_id");
@@ -11,8 +20,15 @@ export async function GET(req) {
     );
   }
 
+  // Pagination, filter and sort params are passed through unchanged.
+  const query = new URLSearchParams({ parent_id: parentId });
+  for (const key of LIST_PARAMS) {
+    const value = searchParams.get(key);
+    if (value) query.set(key, value);
+  }
+
   const backendRes = await fetch(
-    `${process.env.BACKEND_API_URL}/api/ls?parent_id=${parentId}`,
+    `${process.env.BACKEND_API_URL}/api/ls?${query}`,
     {
       headers: {
         "X-User-Id": "juwon",
@@ -0,0 +1,38 @@
+import { NextResponse } from "next/server";
+
+const QUERY_PARAMS = ["status", "priority", "updated_since", "sort", "limit"];
+
+export async function GET(req) {
+  const { searchParams } = new URL(req.url);
+  const parentId = searchParams.get("parent_id");
+
+  if (!parentId) {
+    return new Response(
+      JSON.stringify({ error: "missing parent_id" }),
+      { status: 400 }
+    );
+  }
+
+  const query = new URLSearchParams({ parent_id: parentId });
+  for (const key of QUERY_PARAMS) {
+    const value = searchParams.get(key);
+    if (value) query.set(key, value);
+  }
+
+  const backendRes = await fetch(
+    `${process.env.BACKEND_API_URL}/api/query?${query}`,
+    {
+      headers: {
+        "X-User-Id": "juwon",
+      },
+      cache: "no-store",
+    }
+  );
+
+  const text = await backendRes.text();
+
+  return new Response(text, {
+    status: backendRes.status,
+    headers: { "Content-Type": "application/json" },
+  });
+}
@@ -0,0 +1,38 @@
+import { NextResponse } from "next/server";
+
+const SEARCH_PARAMS = ["limit", "offset"];
+
+export async function GET(req) {
+  const { searchParams } = new URL(req.url);
+  const q = searchParams.get("q");
+
+  if (!q) {
+    return new Response(
+      JSON.stringify({ error: "missing q" }),
+      { status: 400 }
+    );
+  }
+
+  const query = new URLSearchParams({ q });
+  for (const key of SEARCH_PARAMS) {
+    const value = searchParams.get(key);
+    if (value) query.set(key, value);
+  }
+
+  const backendRes = await fetch(
+    `${process.env.BACKEND_API_URL}/api/search?${query}`,
+    {
+      headers: {
+        "X-User-Id": "juwon",
+      },
+      cache: "no-store",
+    }
+  );
+
+  const text = await backendRes.text();
+
+  return new Response(text, {
+    status: backendRes.status,
+    headers: { "Content-Type": "application/json" },
+  });
+}
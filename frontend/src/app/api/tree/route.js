@@ -0,0 +1,31 @@
+import { NextResponse } from "next/server";
+
+export async function GET(req) {
+  const { searchParams } = new URL(req.url);
+  const rootId = searchParams.get("root_id");
+  const depth = searchParams.get("depth") ?? "2";
+
+  if (!rootId) {
+    return new Response(
+      JSON.stringify({ error: "missing root_id" }),
+      { status: 400 }
+    );
+  }
+
+  const backendRes = await fetch(
+    `${process.env.BACKEND_API_URL}/api/tree?root_id=${rootId}&depth=${depth}`,
+    {
+      headers: {
+        "X-User-Id": "juwon",
+      },
+      cache: "no-store",
+    }
+  );
+
+  const text = await backendRes.text();
+
+  return new Response(text, {
+    status: backendRes.status,
+    headers: { "Content-Type": "application/json" },
+  });
+}
@@ -2,8 +2,7 @@
 
 import { useEffect, useState } from "react";
 import TreeNode from "./TreeNode";
-import { fetchChildrenClient } from "@/lib/clientApi";
-import { childrenCache, hasChildrenCache } from "./treeCache";
+import { loadTwoLevels } from "./treeCache";
 import "./tree.css";
 import "../modal/spinner.css";
 
@@ -21,25 +20,9 @@ export default function Tree({
 
     async function eagerLoadTwoLevels() {
       for (const node of nodes) {
-        const parentId = node.id;
-
         try {
-          const level1 = await fetchChildrenClient(parentId);
+          await loadTwoLevels(node.id);
           if (cancelled) return;
-
-          childrenCache.set(parentId, level1);
-          hasChildrenCache.set(parentId, level1.length > 0);
-
-          for (const child of level1) {
-            const childId = child.id;
-            if (childrenCache.has(childId)) continue;
-
-            const level2 = await fetchChildrenClient(childId);
-            if (!cancelled) {
-              childrenCache.set(childId, level2);
-              hasChildrenCache.set(childId, level2.length > 0);
-            }
-          }
         } catch {}
       }
 
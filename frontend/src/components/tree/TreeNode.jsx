@@ -1,11 +1,11 @@
 "use client";
 
 import { useState } from "react";
-import { fetchChildrenClient, modifyNode } from "@/lib/clientApi";
+import { modifyNode } from "@/lib/clientApi";
 import ModifyNodeModal from "@/components/modal/ModifyNodeModal";
 import DeleteConfirmModal from "@/components/modal/DeleteConfirmModal";
 import ContextMenu from "@/components/contextmenu/ContextMenu";
-import { childrenCache, hasChildrenCache } from "./treeCache";
+import { childrenCache, hasChildrenCache, loadTwoLevels } from "./treeCache";
 
 
 function priorityClass(priority) {
@@ -33,6 +33,13 @@ function formatTime(ts) {
   return new Date(ts * 1000).toLocaleString();
 }
 
+function rollupSummary(rollup) {
+  if (!rollup || rollup.descendants === 0) return null;
+  const percent = Math.round(rollup.completion_percent);
+  const blocked = rollup.by_status[3];
+  return `${rollup.descendants} tasks, ${percent}% complete, ${blocked} blocked`;
+}
+
 function nodeIcon(hasChildren, expanded) {
   if (!hasChildren) return "📄";
   if (expanded) return "📂";
@@ -41,24 +48,12 @@ function nodeIcon(hasChildren, expanded) {
 
 
 async function eagerLoadTwoLevels(parentId) {
-  let level1;
-
-  if (childrenCache.has(parentId)) {
-    level1 = childrenCache.get(parentId);
-  } else {
-    level1 = await fetchChildrenClient(parentId);
-    childrenCache.set(parentId, level1);
-    hasChildrenCache.set(parentId, level1.length > 0);
+  const level1 = childrenCache.get(parentId);
+  if (level1 && level1.every((child) => childrenCache.has(child.id) || !hasChildrenCache.get(child.id))) {
+    return;
   }
 
-  for (const child of level1) {
-    const childId = child.id;
-    if (childrenCache.has(childId)) continue;
-
-    const level2 = await fetchChildrenClient(childId);
-    childrenCache.set(childId, level2);
-    hasChildrenCache.set(childId, level2.length > 0);
-  }
+  await loadTwoLevels(parentId);
 }
 
 
@@ -168,6 +163,14 @@ export default function TreeNode({
             <span className="meta-time">
               Updated {formatTime(localNode.last_updated_at)}
             </span>
+            {rollupSummary(localNode.rollup) && (
+              <>
+                <span className="meta-dot">•</span>
+                <span className="meta-rollup">
+                  {rollupSummary(localNode.rollup)}
+                </span>
+              </>
+            )}
           </div>
         </div>
 
@@ -1,2 +1,37 @@
+import { fetchChildrenClient, fetchSubtreeClient } from "@/lib/clientApi";
+
 export const childrenCache = new Map();
-export const hasChildrenCache = new Map();
\ No newline at end of file
+export const hasChildrenCache = new Map();
+
+// Fills the caches from a nested /api/tree listing. Only nodes the server
+// expanded (those carrying a "children" array) get a childrenCache entry;
+// the rest just record whether they can be expanded later.
+export function cacheSubtree(parentId, nodes) {
+  const level = nodes.map(({ children, has_children, ...node }) => node);
+  childrenCache.set(parentId, level);
+  hasChildrenCache.set(parentId, level.length > 0);
+
+  for (const node of nodes) {
+    if (node.children) {
+      cacheSubtree(node.id, node.children);
+    } else {
+      hasChildrenCache.set(node.id, node.has_children);
+    }
+  }
+}
+
+// Loads two levels below parentId with a single /api/tree request. If the
+// server cut the listing short, only the first level is cached (via
+// /api/ls) so no partial child list ends up in childrenCache.
+export async function loadTwoLevels(parentId) {
+  const subtree = await fetchSubtreeClient(parentId, 2);
+
+  if (!subtree.truncated) {
+    cacheSubtree(parentId, subtree.children);
+    return;
+  }
+
+  const level1 = await fetchChildrenClient(parentId);
+  childrenCache.set(parentId, level1);
+  hasChildrenCache.set(parentId, level1.length > 0);
+}
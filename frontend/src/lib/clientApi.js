@@ -10,6 +10,18 @@ export async function fetchChildrenClient(parentId) {
   return res.json();
 }
 
+export async function fetchSubtreeClient(rootId, depth = 2) {
+  const res = await fetch(`/api/tree?root_id=${rootId}&depth=${depth}`, {
+    cache: "no-store",
+  });
+
+  if (!res.ok) {
+    throw new Error("Failed to fetch subtree");
+  }
+
+  return res.json();
+}
+
 export async function createNode(payload) {
   const res = await fetch("/api/create", {
     method: "POST",
@@ -36,4 +48,30 @@ export async function modifyNode(payload) {
   }
 
   return res.json();
-}
\ No newline at end of file
+}
+
+export async function queryChildrenClient(parentId, filters = {}) {
+  const query = new URLSearchParams({ parent_id: parentId, ...filters });
+  const res = await fetch(`/api/query?${query}`, {
+    cache: "no-store",
+  });
+
+  if (!res.ok) {
+    throw new Error("Failed to query children");
+  }
+
+  return res.json();
+}
+
+export async function searchTasksClient(q, { limit = 20, offset = 0 } = {}) {
+  const query = new URLSearchParams({ q, limit, offset });
+  const res = await fetch(`/api/search?${query}`, {
+    cache: "no-store",
+  });
+
+  if (!res.ok) {
+    throw new Error("Failed to search tasks");
+  }
+
+  return res.json();
+}